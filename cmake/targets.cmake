@@ -32,17 +32,29 @@ if (PLATFORM_LINUX OR PLATFORM_WINDOWS)
                 COMMAND ${MSYS_ROOT}usr/bin/bash -l ${cross2d_SOURCE_DIR}/cmake/mingw_copy_libs.sh "${CMAKE_CURRENT_BINARY_DIR}/${PROJECT_NAME}${CMAKE_EXECUTABLE_SUFFIX}"
                 COMMENT "Copying required mingw dependencies...")
     endif ()
+    if (OPTION_ROMFS_PACK)
+        # ship romfs as one archive, mounted over data_romfs by the renderer io (see tools/romfs_pack.cpp)
+        set(ROMFS_RELEASE_COMMANDS
+                COMMAND $<TARGET_FILE:c2d_romfs_pack> ${CMAKE_CURRENT_BINARY_DIR}/data_romfs ${CMAKE_BINARY_DIR}/release/${PROJECT_NAME}/data_romfs.pak)
+    else ()
+        set(ROMFS_RELEASE_COMMANDS
+                COMMAND ${CMAKE_COMMAND} -E make_directory ${CMAKE_BINARY_DIR}/release/${PROJECT_NAME}/data_romfs
+                COMMAND ${CMAKE_COMMAND} -D SRC=${CMAKE_CURRENT_BINARY_DIR}/data_romfs -D DST=${CMAKE_BINARY_DIR}/release/${PROJECT_NAME}/data_romfs -P ${CMAKE_CURRENT_LIST_DIR}/copy_custom.cmake)
+    endif ()
     add_custom_target(${PROJECT_NAME}_${TARGET_PLATFORM}_release
             DEPENDS ${PROJECT_NAME}
             COMMAND ${CMAKE_COMMAND} -E remove -f ${CMAKE_BINARY_DIR}/${PROJECT_NAME}-${VERSION_MAJOR}.${VERSION_MINOR}_${TARGET_PLATFORM}.zip
             COMMAND ${CMAKE_COMMAND} -E remove_directory ${CMAKE_BINARY_DIR}/release/${PROJECT_NAME}
-            COMMAND ${CMAKE_COMMAND} -E make_directory ${CMAKE_BINARY_DIR}/release/${PROJECT_NAME}/data_romfs
+            COMMAND ${CMAKE_COMMAND} -E make_directory ${CMAKE_BINARY_DIR}/release/${PROJECT_NAME}
             COMMAND ${CMAKE_COMMAND} -E copy "${CMAKE_CURRENT_BINARY_DIR}/${PROJECT_NAME}${CMAKE_EXECUTABLE_SUFFIX}" ${CMAKE_BINARY_DIR}/release/${PROJECT_NAME}/
             COMMAND ${CMAKE_COMMAND} -D SRC=${CMAKE_CURRENT_BINARY_DIR}/*.dll -D DST=${CMAKE_BINARY_DIR}/release/${PROJECT_NAME} -P ${CMAKE_CURRENT_LIST_DIR}/copy_custom.cmake
             COMMAND ${CMAKE_COMMAND} -D SRC=${CMAKE_CURRENT_BINARY_DIR}/data_datadir -D DST=${CMAKE_BINARY_DIR}/release/${PROJECT_NAME} -P ${CMAKE_CURRENT_LIST_DIR}/copy_custom.cmake
-            COMMAND ${CMAKE_COMMAND} -D SRC=${CMAKE_CURRENT_BINARY_DIR}/data_romfs -D DST=${CMAKE_BINARY_DIR}/release/${PROJECT_NAME}/data_romfs -P ${CMAKE_CURRENT_LIST_DIR}/copy_custom.cmake
+            ${ROMFS_RELEASE_COMMANDS}
             COMMAND cd ${CMAKE_BINARY_DIR}/release && ${ZIP} -r ../${PROJECT_NAME}-${VERSION_MAJOR}.${VERSION_MINOR}_${TARGET_PLATFORM}.zip ${PROJECT_NAME}
     )
+    if (OPTION_ROMFS_PACK)
+        add_dependencies(${PROJECT_NAME}_${TARGET_PLATFORM}_release c2d_romfs_pack)
+    endif ()
 endif ()
 
 ########################
@@ -7,8 +7,15 @@
 
 #include "cross2d/skeleton/object.h"
 #include "cross2d/skeleton/io.h"
+#include "cross2d/skeleton/io_cache.h"
+#include "cross2d/skeleton/io_async.h"
+#include "cross2d/skeleton/io_zip.h"
+#include "cross2d/skeleton/io_hash.h"
 #include "cross2d/skeleton/input.h"
+#include "cross2d/skeleton/input_record.h"
 #include "cross2d/skeleton/audio.h"
+#include "cross2d/skeleton/mixer.h"
+#include "cross2d/skeleton/audio_null.h"
 #include "cross2d/skeleton/sfml/Rectangle.hpp"
 #include "cross2d/skeleton/sfml/RectangleShape.hpp"
 #include "cross2d/skeleton/sfml/CircleShape.hpp"
@@ -25,6 +32,7 @@
 #include "cross2d/skeleton/thread.h"
 #include "cross2d/skeleton/mutex.h"
 #include "cross2d/skeleton/cond.h"
+#include "cross2d/skeleton/thread_pool.h"
 #include "cross2d/skeleton/device.h"
 #include "cross2d/widgets/button.h"
 #include "cross2d/widgets/textbox.h"
@@ -11,6 +11,10 @@ namespace c2d {
 
     public:
         static std::string getName();
+
+        static int getCpuCount() {
+            return SDL_GetCPUCount();
+        }
     };
 }
 
@@ -18,6 +18,8 @@ namespace c2d {
 
         Type getType(const std::string &file) override;
 
+        int64_t getModificationTime(const std::string &path) override;
+
         bool create(const std::string &path) override;
 
         bool removeFile(const std::string &path) override;
@@ -32,20 +34,34 @@ namespace c2d {
         std::vector<File> findFiles(const std::string &path, const std::vector<std::string> &whitelist,
                                     const std::string &blacklist = "", bool stopOnFirst = true) override;
 
+        size_t findFilesRecursive(const std::string &path, const std::vector<std::string> &extensions,
+                                  const std::function<bool(const File &file)> &callback,
+                                  const std::string &blacklist = "") override;
+
         size_t read(const std::string &file, char *out, size_t size = 0, size_t offset = 0) override;
 
         bool write(const std::string &file, const char *data, size_t size) override;
 
+        Map *map(const std::string &file, Advice advice = Advice::Sequential) override;
+
+        bool isMappable(const std::string &file) override;
+
+        bool resolve(File *file) override;
+
         std::string getDataPath() override;
 
         std::string getRomFsPath() override;
 
     private:
         bool _copy(const std::string &src, const std::string &dst,
-                   const std::function<void(File, File, float)> &callback = nullptr);
+                   const std::function<void(File, File, float)> &callback,
+                   std::vector<std::pair<File, File>> *files);
+
+        bool _copyFiles(const std::vector<std::pair<File, File>> &files,
+                        const std::function<void(File, File, float)> &callback = nullptr);
 
-        static bool _copyFile(const File &src, const File &dst,
-                              const std::function<void(File, File, float)> &callback = nullptr);
+        bool _copyFile(const File &src, const File &dst,
+                       const std::function<void(File, File, float)> &callback = nullptr);
     };
 }
 
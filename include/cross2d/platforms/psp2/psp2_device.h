@@ -15,6 +15,11 @@ namespace c2d {
         static Vector2i getDisplaySize() {
             return {960, 544};
         }
+
+        static int getCpuCount() {
+            // four cores, one is reserved by the system
+            return 3;
+        }
     };
 }
 
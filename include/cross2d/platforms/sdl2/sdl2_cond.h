@@ -16,8 +16,12 @@ namespace c2d {
 
         int wait(Mutex *mutex) override;
 
+        int waitTimeout(Mutex *mutex, unsigned int ms) override;
+
         int signal() override;
 
+        int broadcast() override;
+
     private:
         SDL_cond *cond;
     };
@@ -11,6 +11,8 @@ namespace c2d {
         static std::string getName();
 
         static Vector2i getDisplaySize();
+
+        static int getCpuCount();
     };
 }
 
@@ -9,6 +9,8 @@
 
 namespace c2d {
 
+    // event driven: controllers and keyboard state is maintained from the sdl event queue,
+    // so update() cost doesn't depend on the mappings and presses shorter than a frame are kept
     class SDL2Input : public Input {
 
     public:
@@ -20,6 +22,11 @@ namespace c2d {
 
         int waitButton(int player = 0) override;
 
+        void setJoystickMapping(int player, const std::vector<ButtonMapping> &mapping,
+                                const Vector2i &leftAxis, const Vector2i &rightAxis, int dz) override;
+
+        void setKeyboardMapping(const std::vector<ButtonMapping> &mapping) override;
+
     protected:
         Vector2f getAxisState(const Player &player, int xAxis, int yAxis) override;
 
@@ -28,6 +35,40 @@ namespace c2d {
         int getKeyState(int key) override;
 
         Vector2f getTouch() override;
+
+        unsigned int getMappedButtons(const Player &player) override;
+
+        unsigned int getMappedKeys() override;
+
+        bool pollSnapshot(Snapshot *snapshot) override;
+
+    private:
+        // controller buttons, then the two triggers used as buttons (mapping value: axis + 100)
+        static const int SourceCount = SDL_CONTROLLER_BUTTON_MAX + 2;
+
+        static int getSource(int value);
+
+        void handleEvent(const SDL_Event &event, int64_t time);
+
+        int getPlayerIndex(SDL_JoystickID id);
+
+        void setSource(int player, int source, bool pressed, int64_t time);
+
+        void setKey(int key, bool pressed, int64_t time);
+
+        void buildLookup(int player);
+
+        // per player: mapped buttons of each source, pressed sources, resulting mapped buttons
+        unsigned int m_source_buttons[PLAYER_MAX][SourceCount] = {};
+        uint32_t m_sources[PLAYER_MAX] = {};
+        unsigned int m_buttons[PLAYER_MAX] = {};
+        short m_axes[PLAYER_MAX][SDL_CONTROLLER_AXIS_MAX] = {};
+        SDL_JoystickID m_ids[PLAYER_MAX];
+        // keyboard
+        std::vector<uint8_t> m_keys;
+        unsigned int m_key_buttons = 0;
+        // mappings lookup is also read by the polling thread
+        Mutex *m_mutex = nullptr;
     };
 }
 
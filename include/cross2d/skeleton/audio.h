@@ -6,11 +6,17 @@
 #define C2D_AUDIO_H
 
 #include <cstring>
+#include <vector>
+#include <atomic>
 #include "cross2d/skeleton/mutex.h"
+#include "cross2d/skeleton/cond.h"
 #include "audio_buffer.h"
+#include "resampler.h"
 
 namespace c2d {
 
+    class Mixer;
+
     class Audio {
 
     public:
@@ -18,17 +24,68 @@ namespace c2d {
         enum SyncMode {
             None = 0,
             LowLatency = 1,
-            Safe = 2
+            Safe = 2,
+            // never block: resample the input with a ratio continuously adjusted
+            // from the buffer fill level to keep it half full (dynamic rate control)
+            DynamicRate = 3
         };
 
         typedef void (*C2DAudioCallback)(void *data, unsigned char *stream, int len);
 
+        // play() input sample formats, converted to the device format (S16) when pushed
+        enum Format {
+            S16 = 0,
+            S32 = 1,
+            F32 = 2
+        };
+
+        static const int StatsHistogramSize = 16;
+
+        struct Stats {
+            unsigned int callbacks = 0;     // device callbacks recorded
+            unsigned int underruns = 0;     // callbacks without enough queued samples
+            unsigned int overruns = 0;      // play() calls dropping samples because the buffer was full
+            int queued = 0;                 // queued samples at the last callback
+            int queuedMin = 0;              // min/max queued samples seen at callbacks
+            int queuedMax = 0;
+            float intervalUs = 0;           // smoothed callback interval
+            float jitterUs = 0;             // smoothed callback interval deviation (rfc 3550 style)
+            float latencyMs = 0;            // estimated output latency (queued samples + one device buffer)
+            // queued level at callbacks, bucket i covers [i, i + 1) / StatsHistogramSize of the capacity.
+            // Rolling: counts are halved every 1024 callbacks. Only filled when enabled.
+            unsigned int histogram[StatsHistogramSize] = {};
+        };
+
         Audio(int rate = 48000, int samples = 1024, C2DAudioCallback cb = nullptr);
 
         virtual ~Audio();
 
+        // "samples" is the number of frames of the input format, see setInputFormat
         virtual void play(const void *data, int samples, SyncMode syncMode = None);
 
+        // declare the play() data format: S16, S32 or F32 (-1.0 to 1.0), 1 to 8 interleaved channels
+        // (wav/smpte order: FL FR FC LFE BL BR SL SR). It's converted, and down/up mixed, to the
+        // device format while being pushed. Default is the device format (S16 stereo).
+        void setInputFormat(Format format, int channels);
+
+        Format getInputFormat();
+
+        int getInputChannels();
+
+        // declare the play() data sample rate, resampled to the device rate (0: device rate)
+        void setInputRate(int rate);
+
+        int getInputRate();
+
+        // resampling quality used for the input rate conversion and the DynamicRate sync mode
+        // (default: Cubic). See Resampler::benchmark to pick one for the device.
+        void setResamplerQuality(Resampler::Quality quality);
+
+        Resampler::Quality getResamplerQuality();
+
+        // the resampler in use, nullptr until play() needs it (for cost statistics)
+        Resampler *getResampler();
+
         virtual void pause(int pause);
 
         virtual void reset();
@@ -41,6 +98,28 @@ namespace c2d {
 
         bool unlock();
 
+        // mix "mixer" voices over the play() stream, in the device callback (nullptr to disable).
+        // The mixer is not owned by the audio instance.
+        void setMixer(Mixer *mixer);
+
+        Mixer *getMixer();
+
+        // to be called by the audio backends at the beginning of each device callback (before pulling)
+        void recordCallback();
+
+        // to be called by the audio backends when a callback didn't get enough samples
+        void recordUnderrun();
+
+        Stats getStats();
+
+        void resetStats();
+
+        void setStatsHistogram(bool enable);
+
+        // to be called by the audio backends after pulling samples from the buffer,
+        // wakes up a producer waiting for space (LowLatency and Safe sync modes)
+        void notify();
+
         bool isAvailable();
 
         int getChannels();
@@ -61,8 +140,31 @@ namespace c2d {
 
         static int toSamples(int rate, float fps);
 
+        // create the audio backend selected at runtime by the C2D_AUDIO_DRIVER environment variable:
+        // "null" (NullAudio), "file" (FileAudio, to the C2D_AUDIO_FILE path, "c2d_audio.wav" by default)
+        // or the platform backend (C2DAudio) when unset
+        static Audio *create(int rate = 48000, int samples = 2048, C2DAudioCallback cb = nullptr);
+
+        // maximum deviation of the DynamicRate resampling ratio (default: 0.005, +/- 0.5%)
+        void setDynamicRateDelta(float delta);
+
+        float getDynamicRateDelta();
+
+        // last rate adjustment used by the DynamicRate sync mode, on top of the input rate conversion
+        double getDynamicRateRatio();
+
     protected:
 
+        // wait until at most "maxQueued" samples are queued, returns false if audio became unavailable
+        bool waitQueued(int maxQueued);
+
+        // convert "frames" input frames to device frames into "dst"
+        void convert(const void *src, int16_t *dst, int frames);
+
+        // resample "frames" device format frames to m_resample_buffer, from the input rate to the
+        // device rate scaled by "adjust", returns the number of output samples
+        int resample(const int16_t *src, int frames, double adjust);
+
         int m_sample_rate = 48000;
         int channels = 2;
         SampleBuffer *m_buffer = nullptr;
@@ -71,9 +173,35 @@ namespace c2d {
         bool paused = false;
         bool available = false;
         C2DAudioCallback callback = nullptr;
+        float m_drc_delta = 0.005f;
+        double m_drc_ratio = 1.0;
+        int m_input_rate = 0;
+        Resampler *m_resampler = nullptr;
+        Resampler::Quality m_resampler_quality = Resampler::Cubic;
+        std::vector<int16_t> m_resample_buffer;
+        Format m_input_format = S16;
+        int m_input_channels = 2;
+        float m_downmix[2][8] = {};
+        std::vector<int16_t> m_convert_buffer;
 
     private:
         c2d::Mutex *mutex = nullptr;
+        c2d::Cond *cond = nullptr;
+        std::atomic<bool> waiting{false};
+        std::atomic<Mixer *> m_mixer{nullptr};
+        // stats, written by the audio thread (overruns by the producer), read from anywhere
+        std::atomic<unsigned int> m_stats_callbacks{0};
+        std::atomic<unsigned int> m_stats_underruns{0};
+        std::atomic<unsigned int> m_stats_overruns{0};
+        std::atomic<int> m_stats_queued{0};
+        std::atomic<int> m_stats_queued_min{0};
+        std::atomic<int> m_stats_queued_max{0};
+        std::atomic<float> m_stats_interval{0};
+        std::atomic<float> m_stats_jitter{0};
+        std::atomic<unsigned int> m_stats_histogram[StatsHistogramSize] = {};
+        std::atomic<bool> m_stats_histogram_enabled{false};
+        std::atomic<bool> m_stats_reset{false};
+        int64_t m_stats_last_us = 0;
     };
 }
 
@@ -2,29 +2,21 @@
 #define AUDIO_BUFFER_H
 
 #include <cstring>
-
-#if __cplusplus >= 201103L
-
 #include <cstdint>
-
-#else
-
-#include <stdint.h>
-
-#endif
+#include <atomic>
 
 namespace c2d {
+
+    // Single producer (Audio::play), single consumer (audio callback) lock-free ring buffer.
+    // Storage is a power of two so indices are free running counters masked on access,
+    // the producer owns m_head, the consumer owns m_tail. clear() is only a request from the
+    // producer, applied by the consumer at its next pull (see below).
     class SampleBuffer {
     public:
-        SampleBuffer() {
-            m_buffer_size = 0;
-            m_buffer = nullptr;
-        }
+        SampleBuffer() = default;
 
         explicit SampleBuffer(int num_samples) {
-            m_buffer_size = num_samples;
-            m_buffer = new int16_t[m_buffer_size];
-            clear();
+            resize(num_samples);
         }
 
         ~SampleBuffer() {
@@ -32,43 +24,74 @@ namespace c2d {
             m_buffer = nullptr;
         }
 
+        // Drop queued samples. Safe to call from the producer side while the consumer runs: the
+        // consumer may be copying the queued slots, so it drops them itself (tail = head) in its
+        // next pull or space_readable call. Until then the producer sees no queued samples and
+        // no space, so it can't overwrite slots the consumer still reads.
         inline void clear() {
             if (m_buffer == nullptr) return;
-            m_start = 0;
-            m_size = 0;
-            memset(m_buffer, 0, m_buffer_size * 2);
+            m_clear_request.fetch_add(1, std::memory_order_release);
+        }
+
+        // consumer side: apply a pending clear(), then return the number of queued samples
+        inline int space_readable() {
+            uint32_t request = m_clear_request.load(std::memory_order_acquire);
+            if (request != m_clear_done.load(std::memory_order_relaxed)) {
+                // the producer can't push while the request is pending, so head is stable here
+                m_tail.store(m_head.load(std::memory_order_acquire), std::memory_order_release);
+                m_clear_done.store(request, std::memory_order_release);
+            }
+            uint32_t tail = m_tail.load(std::memory_order_relaxed);
+            uint32_t head = m_head.load(std::memory_order_acquire);
+            return (int) (head - tail);
         }
 
+        // consumer side
         inline bool pull(int16_t *dst, int num_samples) {
-            if (space_filled() < num_samples)
+            if (space_readable() < num_samples)
                 return false;
 
-            memcpy(dst, m_buffer + m_start, min(num_samples, m_buffer_size - m_start) * 2);
+            uint32_t tail = m_tail.load(std::memory_order_relaxed);
+            uint32_t start = tail & m_mask;
+            int first_read_size = min(num_samples, (int) (m_mask + 1 - start));
+            memcpy(dst, m_buffer + start, first_read_size * 2);
+            if (num_samples > first_read_size)
+                memcpy(dst + first_read_size, m_buffer, (num_samples - first_read_size) * 2);
 
-            if (num_samples > (m_buffer_size - m_start))
-                memcpy(dst + (m_buffer_size - m_start), m_buffer, (num_samples - (m_buffer_size - m_start)) * 2);
-
-            m_start = (m_start + num_samples) % m_buffer_size;
-            m_size -= num_samples;
+            m_tail.store(tail + num_samples, std::memory_order_release);
 
             return true;
         }
 
+        // producer side
         inline bool push(int16_t *src, int num_samples) {
             if (space_empty() < num_samples) return false;
 
-            int end = m_start + m_size;
-            if (end > m_buffer_size) end -= m_buffer_size;
+            uint32_t head = m_head.load(std::memory_order_relaxed);
 
             // if src is null, assume SampleBuffer was filled manually
             if (src) {
-                int first_write_size = min(num_samples, m_buffer_size - end);
+                uint32_t end = head & m_mask;
+                int first_write_size = min(num_samples, (int) (m_mask + 1 - end));
                 memcpy(m_buffer + end, src, first_write_size * 2);
                 if (num_samples > first_write_size)
                     memcpy(m_buffer, src + first_write_size, (num_samples - first_write_size) * 2);
             }
 
-            m_size += num_samples;
+            m_head.store(head + num_samples, std::memory_order_release);
+
+            return true;
+        }
+
+        // producer side: get the (up to two, because of wrapping) regions where "num_samples" samples
+        // can be written in place, then commit them with push(nullptr, num_samples)
+        inline bool reserve(int num_samples, int16_t **first, int *first_size, int16_t **second) {
+            if (space_empty() < num_samples) return false;
+
+            uint32_t end = m_head.load(std::memory_order_relaxed) & m_mask;
+            *first = m_buffer + end;
+            *first_size = min(num_samples, (int) (m_mask + 1 - end));
+            *second = m_buffer;
 
             return true;
         }
@@ -77,26 +100,47 @@ namespace c2d {
             return m_buffer_size;
         }
 
+        // a pending clear() makes the buffer full for the producer, the consumer still owns the slots
         inline int space_empty() const {
-            return m_buffer_size - m_size;
+            if (clear_pending()) return 0;
+            return m_buffer_size - space_filled();
         }
 
         inline int space_filled() const {
-            return m_size;
+            if (clear_pending()) return 0;
+            uint32_t tail = m_tail.load(std::memory_order_acquire);
+            uint32_t head = m_head.load(std::memory_order_acquire);
+            return (int) (head - tail);
         }
 
+        // not thread safe, must be called while the consumer is stopped
         void resize(int num_samples) {
-            if (m_buffer) delete[] m_buffer;
+            uint32_t size = 1;
+            while (size < (uint32_t) num_samples) size <<= 1;
+
+            delete[] m_buffer;
+            m_buffer = new int16_t[size];
+            memset(m_buffer, 0, size * 2);
+            m_mask = size - 1;
             m_buffer_size = num_samples;
-            m_buffer = new int16_t[m_buffer_size];
-            clear();
+            m_head.store(0, std::memory_order_relaxed);
+            m_tail.store(0, std::memory_order_relaxed);
+            m_clear_done.store(m_clear_request.load(std::memory_order_relaxed), std::memory_order_relaxed);
         }
 
     private:
-        int m_size = 0;
-        int m_start = 0;
-        int16_t *m_buffer;
-        int m_buffer_size;
+        inline bool clear_pending() const {
+            return m_clear_request.load(std::memory_order_acquire) != m_clear_done.load(std::memory_order_acquire);
+        }
+
+        std::atomic<uint32_t> m_head{0};
+        std::atomic<uint32_t> m_tail{0};
+        // clear() sequence numbers: requested by the producer, acknowledged by the consumer
+        std::atomic<uint32_t> m_clear_request{0};
+        std::atomic<uint32_t> m_clear_done{0};
+        int16_t *m_buffer = nullptr;
+        uint32_t m_mask = 0;
+        int m_buffer_size = 0; ///< usable capacity, the storage is rounded up to a power of two
 
         static inline int min(int a, int b) {
             return ((a) < (b) ? (a) : (b));
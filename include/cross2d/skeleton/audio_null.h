@@ -0,0 +1,79 @@
+//
+// Created by cpasjuste on 17/10/2026.
+//
+
+#ifndef C2D_AUDIO_NULL_H
+#define C2D_AUDIO_NULL_H
+
+#include <string>
+#include <cstdio>
+#include "cross2d/skeleton/audio.h"
+
+namespace c2d {
+
+    class Thread;
+
+    /// Audio backend without device: a thread consumes one buffer ("samples" frames) per
+    /// period on a virtual clock, exactly like a device callback would, so SyncMode
+    /// timing (blocking, latency, underruns) behaves as with real hardware.
+    class NullAudio : public Audio {
+
+    public:
+
+        explicit NullAudio(int rate = 48000, int samples = 2048, C2DAudioCallback cb = nullptr);
+
+        ~NullAudio() override;
+
+        /// frames consumed by the virtual device since creation
+        long getFramesPlayed();
+
+        /// periods where the buffer didn't hold enough samples
+        int getUnderruns();
+
+    protected:
+
+        NullAudio(int rate, int samples, C2DAudioCallback cb, bool start);
+
+        /// start the consumer thread
+        void start();
+
+        /// called from the consumer thread with each period content (silence on underrun)
+        virtual void onPeriod(const int16_t *samples, int frames) {};
+
+        /// stop the consumer thread, derived classes must call it first in their destructor
+        void stop();
+
+    private:
+
+        static int consumerThread(void *data);
+
+        Thread *m_thread = nullptr;
+        std::vector<int16_t> m_period;
+        std::atomic<long> m_frames_played{0};
+        std::atomic<bool> m_quit{false};
+    };
+
+    /// NullAudio backend writing everything played (including underruns silence) to a wav file
+    class FileAudio : public NullAudio {
+
+    public:
+
+        explicit FileAudio(const std::string &path, int rate = 48000,
+                           int samples = 2048, C2DAudioCallback cb = nullptr);
+
+        ~FileAudio() override;
+
+    protected:
+
+        void onPeriod(const int16_t *samples, int frames) override;
+
+    private:
+
+        void writeHeader();
+
+        FILE *m_file = nullptr;
+        uint32_t m_data_size = 0;
+    };
+}
+
+#endif //C2D_AUDIO_NULL_H
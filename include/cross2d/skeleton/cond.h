@@ -7,6 +7,8 @@
 
 #include <cstdio>
 
+#define C2D_COND_TIMEDOUT 1
+
 namespace c2d {
 
     class Cond {
@@ -21,10 +23,21 @@ namespace c2d {
             return -1;
         };
 
+        // returns 0 if signaled, C2D_COND_TIMEDOUT on timeout, -1 on error
+        virtual int waitTimeout(Mutex *mutex, unsigned int ms) {
+            printf("c2d::Cond:waitTimeout: unimplemented\n");
+            return -1;
+        };
+
         virtual int signal() {
             printf("c2d::Cond:signal: unimplemented\n");
             return -1;
         };
+
+        virtual int broadcast() {
+            printf("c2d::Cond:broadcast: unimplemented\n");
+            return -1;
+        };
     };
 }
 
@@ -13,6 +13,8 @@ namespace c2d {
         static std::string getName() { return {}; }
 
         static Vector2i getDisplaySize() { return {}; }
+
+        static int getCpuCount() { return 1; }
     };
 }
 
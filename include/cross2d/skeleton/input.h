@@ -6,6 +6,9 @@
 #define __C2D_INPUT_H__
 
 #include <string>
+#include <vector>
+#include <cstdint>
+#include <atomic>
 #include "cross2d/skeleton/sfml/Clock.hpp"
 #include "cross2d/skeleton/sfml/Vector2.hpp"
 
@@ -17,6 +20,8 @@
 
 namespace c2d {
 
+    class Thread;
+
     class Input {
 
     public:
@@ -84,6 +89,22 @@ namespace c2d {
             std::vector<ButtonMapping> mapping_default{};
         };
 
+        // a mapped button transition (event driven backends report it before rotation)
+        struct Event {
+            int64_t time;           // microseconds, getTime() clock (hardware event time when available)
+            int player;
+            unsigned int button;    // Input::Button
+            bool pressed;
+        };
+
+        // raw controllers state sampled by the polling thread
+        struct Snapshot {
+            int64_t time = 0;                           // getTime() when sampled
+            unsigned int sequence = 0;                  // incremented on each sample
+            unsigned int buttons[PLAYER_MAX] = {};      // mapped buttons, before rotation (no repeat, no touch)
+            short axes[PLAYER_MAX][4] = {};             // lx, ly, rx, ry, without dead zone
+        };
+
         explicit Input();
 
         virtual ~Input();
@@ -98,6 +119,38 @@ namespace c2d {
 
         virtual Player *getPlayers();
 
+        // button transitions collected by the last update, oldest first. Event driven backends
+        // report every transition (a press and release within a frame gives two events),
+        // others compare each update state to the previous one.
+        virtual const std::vector<Event> &getEvents();
+
+        // buttons pressed (released) since the previous update. A press shorter than a frame
+        // is also reported in the player buttons for that update, so it's never lost.
+        virtual unsigned int getPressed(int player = 0);
+
+        virtual unsigned int getReleased(int player = 0);
+
+        // monotonic time, in microseconds, used for Event::time
+        static int64_t getTime();
+
+        // create the platform input (C2DInput), or for scripted runs, when set in the environment:
+        // C2D_INPUT_REPLAY (InputReplay of this file) or C2D_INPUT_RECORD (InputRecorder to this file)
+        static Input *create();
+
+        // start sampling the controllers at "hz" on a dedicated thread, the latest sample being
+        // published without lock (triple buffer). Lets an emulator read the freshest state right
+        // before running its frame ("late latching"), update() and the render loop are unchanged.
+        // Returns false if the backend or the platform doesn't support it.
+        virtual bool startPolling(int hz = 1000);
+
+        // backends must call it first in their destructor
+        virtual void stopPolling();
+
+        bool isPolling();
+
+        // latest published sample (polling thread running), or a sample taken now. Single reader.
+        Snapshot getSnapshot();
+
         virtual std::vector<ButtonMapping> getKeyboardMapping();
 
         virtual std::vector<ButtonMapping> getKeyboardMappingDefault();
@@ -128,16 +181,46 @@ namespace c2d {
 
         virtual Vector2f getTouch() { return {}; };
 
+        // mapped buttons state of a player, polls every mapping with getButtonState by default
+        virtual unsigned int getMappedButtons(const Player &player);
+
+        // mapped keyboard state (player 0), polls every mapping with getKeyState by default
+        virtual unsigned int getMappedKeys();
+
+        // sample the controllers from the polling thread (or getSnapshot caller), false if unsupported
+        virtual bool pollSnapshot(Snapshot *snapshot) { return false; };
+
         virtual void applyRotation(Player *player);
 
+        // for event driven backends: clear the previous update events, then record transitions
+        void clearEvents();
+
+        void pushEvents(int player, unsigned int oldButtons, unsigned int newButtons, int64_t time);
+
         Player m_players[PLAYER_MAX];
         Keyboard m_keyboard{};
+        std::vector<Event> m_events;
+        unsigned int m_pressed[PLAYER_MAX] = {};
+        unsigned int m_released[PLAYER_MAX] = {};
+        // set by backends calling pushEvents, otherwise transitions are computed by update
+        bool m_event_driven = false;
 
     private:
         Clock *m_repeatClock;
         int m_repeatDelay = 150;
         bool m_repeat = false;
         unsigned int m_stateOld = 0;
+        unsigned int m_previous[PLAYER_MAX] = {};
+        // polling thread and its snapshots triple buffer (write, middle and read slots)
+        static int pollingThread(void *data);
+        Thread *m_poll_thread = nullptr;
+        std::atomic<bool> m_poll_quit{false};
+        int m_poll_hz = 1000;
+        Snapshot m_snapshots[3];
+        std::atomic<int> m_snapshot_middle{1};
+        int m_snapshot_write = 0;
+        int m_snapshot_read = 2;
+        unsigned int m_snapshot_sequence = 0;
         Rotation m_dir_rotation = R0;
         Rotation m_button_rotation = R0;
     };
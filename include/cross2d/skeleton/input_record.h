@@ -0,0 +1,110 @@
+//
+// Created by cpasjuste on 17/10/2026.
+//
+
+#ifndef C2D_INPUT_RECORD_H
+#define C2D_INPUT_RECORD_H
+
+#include <string>
+#include <cstdio>
+#include "cross2d/skeleton/input.h"
+
+namespace c2d {
+
+    /// Recording and replay of the players state, one record per update, for scripted runs
+    /// (benchmarks, regressions). File format, little endian:
+    ///   header: "C2DI", u16 version, u8 PLAYER_MAX
+    ///   frame:  u8 mask of the players changed since the previous frame, then for each
+    ///           of them: u8 enabled, u32 buttons, i16 lx ly rx ry, f32 touch x y
+    /// An unchanged frame takes one byte.
+    class InputRecord {
+
+    public:
+
+        static const uint16_t Version = 1;
+
+        static bool writeHeader(FILE *file);
+
+        static bool readHeader(FILE *file);
+
+        /// write "players" changes against "previous" (updated)
+        static bool writeFrame(FILE *file, const Input::Player *players, Input::Player *previous);
+
+        /// apply the next frame to "players", returns false at the end of the file
+        static bool readFrame(FILE *file, Input::Player *players);
+    };
+
+    /// Input decorator recording every update of the wrapped input (owned) to a file
+    class InputRecorder : public Input {
+
+    public:
+
+        InputRecorder(Input *input, const std::string &path);
+
+        ~InputRecorder() override;
+
+        Player *update() override;
+
+        int waitButton(int player = 0) override;
+
+        const std::vector<Event> &getEvents() override;
+
+        unsigned int getPressed(int player = 0) override;
+
+        unsigned int getReleased(int player = 0) override;
+
+        std::vector<ButtonMapping> getKeyboardMapping() override;
+
+        std::vector<ButtonMapping> getKeyboardMappingDefault() override;
+
+        void setRepeatDelay(int ms) override;
+
+        int getRepeatDelay() override;
+
+        void setRotation(const Rotation &dirRotation, const Rotation &buttonRotation) override;
+
+        Rotation getDirRotation() override;
+
+        Rotation getButtonRotation() override;
+
+        void setJoystickMapping(int player, const std::vector<ButtonMapping> &mapping,
+                                const Vector2i &leftAxis, const Vector2i &rightAxis, int dz) override;
+
+        void setKeyboardMapping(const std::vector<ButtonMapping> &mapping) override;
+
+    private:
+
+        Input *m_input = nullptr;
+        FILE *m_file = nullptr;
+        Player m_previous[PLAYER_MAX];
+    };
+
+    /// Input backend feeding a recorded file back, one frame per update, instead of reading
+    /// the hardware. At the end of the file, player 0 gets the Quit button.
+    class InputReplay : public Input {
+
+    public:
+
+        explicit InputReplay(const std::string &path);
+
+        ~InputReplay() override;
+
+        Player *update() override;
+
+        int waitButton(int player = 0) override;
+
+        /// frames replayed so far
+        int getFrame();
+
+        bool isFinished();
+
+    private:
+
+        FILE *m_file = nullptr;
+        unsigned int m_previous[PLAYER_MAX] = {};
+        int m_frame = 0;
+        bool m_finished = false;
+    };
+}
+
+#endif //C2D_INPUT_RECORD_H
@@ -6,12 +6,18 @@
 #define CROSS2D_IO_H
 
 #include <string>
+#include <cstring>
 #include <vector>
+#include <atomic>
+#include <functional>
+#include <unordered_set>
 #include "cross2d/skeleton/sfml/Color.hpp"
 #include "texture.h"
 #include "utility.h"
 
 #define C2D_IO_COPY_BUFFER_SIZE (256 * 1024)
+// minimum time between two progress callbacks of a file copy (10 per second)
+#define C2D_IO_COPY_PROGRESS_INTERVAL_US (100 * 1000)
 
 namespace c2d {
     class Io {
@@ -42,6 +48,109 @@ namespace c2d {
             std::string path;
             size_t size = 0;
             Type type = Type::Unknown;
+            // false when the size (and the type, if Unknown) resolution was deferred, see Io::resolve
+            bool resolved = true;
+        };
+
+        struct ListStats {
+            unsigned long lists = 0;    // getDirList/findFiles calls
+            unsigned long entries = 0;  // entries returned
+            unsigned long stats = 0;    // stat calls made for them
+            double seconds = 0;         // time spent listing
+
+            double getEntriesPerSecond() const {
+                return seconds > 0 ? (double) entries / seconds : 0;
+            }
+        };
+
+        struct CopyStats {
+            unsigned long files = 0;    // files copied
+            uint64_t bytes = 0;         // bytes copied
+            double seconds = 0;         // time spent in copy calls
+
+            double getBytesPerSecond() const {
+                return seconds > 0 ? (double) bytes / seconds : 0;
+            }
+        };
+
+        /// A set of file extensions, "zip" or ".zip", case insensitive. Only the last extension
+        /// of a name is looked up (".gz" for "roms.tar.gz"), so a match costs one hash lookup
+        /// whatever the number of extensions. An empty set matches every name.
+        class ExtensionSet {
+        public:
+            explicit ExtensionSet(const std::vector<std::string> &extensions) {
+                for (const auto &ext: extensions) {
+                    if (ext.empty() || ext == ".") continue;
+                    m_set.insert(Utility::toLower(ext[0] == '.' ? ext : "." + ext));
+                }
+            }
+
+            bool match(const char *name) const {
+                if (m_set.empty()) {
+                    return true;
+                }
+                const char *dot = strrchr(name, '.');
+                if (!dot) {
+                    return false;
+                }
+                std::string ext = dot;
+                for (auto &c: ext) {
+                    c = (char) tolower((unsigned char) c);
+                }
+                return m_set.count(ext) > 0;
+            }
+
+            bool match(const std::string &name) const {
+                return match(name.c_str());
+            }
+
+        private:
+            std::unordered_set<std::string> m_set;
+        };
+
+        /// expected access pattern of a mapped file, passed to the kernel as a hint
+        enum class Advice {
+            Normal = 0,
+            // read once from the start to the end (decoders), read ahead is useful
+            Sequential = 1,
+            // looked up all over the file (font glyphs), read ahead is useless
+            Random = 2
+        };
+
+        /// A read only view of a whole file, see Io::map. The view is memory mapped when
+        /// the platform supports it (pages are read on access, nothing is copied),
+        /// otherwise the file is read into a buffer owned by the view.
+        class Map {
+        public:
+            Map() = default;
+
+            Map(const Map &) = delete;
+
+            Map &operator=(const Map &) = delete;
+
+            virtual ~Map() {
+                delete[] m_buffer;
+            }
+
+            const uint8_t *getData() const {
+                return m_data;
+            }
+
+            size_t getSize() const {
+                return m_size;
+            }
+
+            bool isMapped() const {
+                return m_mapped;
+            }
+
+        protected:
+            friend class Io;
+
+            const uint8_t *m_data = nullptr;
+            size_t m_size = 0;
+            uint8_t *m_buffer = nullptr;
+            bool m_mapped = false;
         };
 
         Io() = default;
@@ -81,6 +190,11 @@ namespace c2d {
             return Type::Unknown;
         };
 
+        /// \return the modification time in nanoseconds since the epoch, -1 if unknown
+        virtual int64_t getModificationTime(const std::string &path) {
+            return -1;
+        }
+
         virtual bool create(const std::string &path) {
             return false;
         };
@@ -107,6 +221,43 @@ namespace c2d {
             return {};
         }
 
+        /// Recursive findFiles: files under "path" with one of "extensions" (see ExtensionSet) are
+        /// passed to "callback" as soon as they are found, in no particular order. Hidden entries
+        /// and names containing "blacklist" (directories too) are skipped. Calls to "callback" are
+        /// serialized, it returns false to stop the scan. This implementation walks getDirList,
+        /// POSIXIo lists subdirectories concurrently (see setScanThreads).
+        /// \return the number of files passed to "callback"
+        virtual size_t findFilesRecursive(const std::string &path, const std::vector<std::string> &extensions,
+                                          const std::function<bool(const File &file)> &callback,
+                                          const std::string &blacklist = "") {
+            const ExtensionSet set(extensions);
+            std::vector<std::string> dirs{path};
+            size_t found = 0;
+
+            while (!dirs.empty()) {
+                std::string dir = dirs.back();
+                dirs.pop_back();
+                for (auto &file: getDirList(dir, false, false)) {
+                    if (!blacklist.empty() && Utility::contains(file.name, blacklist)) {
+                        continue;
+                    }
+                    if (file.type == Type::Unknown) {
+                        resolve(&file);
+                    }
+                    if (file.type == Type::Directory) {
+                        dirs.push_back(file.path);
+                    } else if (set.match(file.name)) {
+                        found++;
+                        if (!callback(file)) {
+                            return found;
+                        }
+                    }
+                }
+            }
+
+            return found;
+        }
+
         virtual size_t read(const std::string &file, char *out, size_t size = 0, size_t offset = 0) {
             return -1;
         }
@@ -115,6 +266,96 @@ namespace c2d {
             return false;
         }
 
+        /// map "file" for reading, the view must be deleted by the caller (it may outlive this Io).
+        /// This default implementation reads the file into the view buffer.
+        /// \return nullptr if the file can't be read
+        virtual Map *map(const std::string &file, Advice advice = Advice::Sequential) {
+            size_t size = getSize(file);
+            if (size == 0 || size == (size_t) -1) {
+                return nullptr;
+            }
+
+            auto view = new Map();
+            view->m_buffer = new uint8_t[size];
+            if (read(file, (char *) view->m_buffer, size) != size) {
+                delete (view);
+                return nullptr;
+            }
+            view->m_data = view->m_buffer;
+            view->m_size = size;
+
+            return view;
+        }
+
+        /// true if map would return a memory mapping of "file" (Map::isMapped), instead of
+        /// reading the whole file into the view buffer
+        virtual bool isMappable(const std::string &file) {
+            return false;
+        }
+
+        /// getDirList/findFiles only read the directory when enabled: the type comes from the
+        /// directory entry when the filesystem provides it, the size is resolved on demand
+        virtual void setDeferredStat(bool enable) {
+            m_deferred_stat = enable;
+        }
+
+        virtual bool getDeferredStat() {
+            return m_deferred_stat;
+        }
+
+        /// resolve the size and type of a deferred entry
+        virtual bool resolve(File *file) {
+            return file->resolved;
+        }
+
+        /// number of files copied concurrently when copying a directory
+        virtual void setCopyThreads(int threads) {
+            m_copy_threads = threads > 0 ? threads : 1;
+        }
+
+        virtual int getCopyThreads() {
+            return m_copy_threads;
+        }
+
+        /// number of directories listed concurrently by findFilesRecursive
+        virtual void setScanThreads(int threads) {
+            m_scan_threads = threads > 0 ? threads : 1;
+        }
+
+        virtual int getScanThreads() {
+            return m_scan_threads;
+        }
+
+        virtual CopyStats getCopyStats() {
+            CopyStats stats;
+            stats.files = m_copy_files.load();
+            stats.bytes = m_copy_bytes.load();
+            stats.seconds = (double) m_copy_us.load() / 1000000.0;
+            return stats;
+        }
+
+        virtual void resetCopyStats() {
+            m_copy_files = 0;
+            m_copy_bytes = 0;
+            m_copy_us = 0;
+        }
+
+        virtual ListStats getListStats() {
+            ListStats stats;
+            stats.lists = m_list_count.load();
+            stats.entries = m_list_entries.load();
+            stats.stats = m_list_stats.load();
+            stats.seconds = (double) m_list_us.load() / 1000000.0;
+            return stats;
+        }
+
+        virtual void resetListStats() {
+            m_list_count = 0;
+            m_list_entries = 0;
+            m_list_stats = 0;
+            m_list_us = 0;
+        }
+
         static bool compare(const Io::File &a, const Io::File &b) {
             if (a.type == Type::Directory && b.type != Type::Directory) {
                 return true;
@@ -127,6 +368,17 @@ namespace c2d {
 
     protected:
         std::string m_data_path{};
+        bool m_deferred_stat = false;
+        std::atomic<unsigned long> m_list_count{0};
+        std::atomic<unsigned long> m_list_entries{0};
+        std::atomic<unsigned long> m_list_stats{0};
+        std::atomic<int64_t> m_list_us{0};
+        int m_copy_threads = 2;
+        // listing is latency bound (slow sd cards, network shares), not cpu bound
+        int m_scan_threads = 4;
+        std::atomic<unsigned long> m_copy_files{0};
+        std::atomic<uint64_t> m_copy_bytes{0};
+        std::atomic<int64_t> m_copy_us{0};
     };
 }
 
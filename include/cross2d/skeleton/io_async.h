@@ -0,0 +1,151 @@
+//
+// Created by cpasjuste on 17/10/2026.
+//
+
+#ifndef C2D_IO_ASYNC_H
+#define C2D_IO_ASYNC_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <functional>
+#include <unordered_map>
+#include "cross2d/skeleton/io.h"
+
+namespace c2d {
+
+    class Mutex;
+
+    class ThreadPool;
+
+    /// Runs Io operations on worker threads so slow storage doesn't stall the render thread.
+    /// Completion callbacks are not called from the workers: they are queued and delivered by
+    /// dispatch(), which the renderer calls at the start of each frame update (see Renderer::getAsyncIo).
+    ///
+    /// Requests are started by priority, then in submission order. A request can be cancelled
+    /// while pending (it won't run) or while running (its result is dropped), in both cases
+    /// its callback is still delivered, with the Cancelled status. Destroying the AsyncIo
+    /// cancels everything and delivers the remaining callbacks from the destructor.
+    ///
+    /// The wrapped Io is not owned and must support concurrent calls (POSIXIo, CachedIo do).
+    class AsyncIo {
+
+    public:
+
+        typedef uint64_t Handle;
+
+        enum class Priority {
+            Low = 0,
+            Normal = 1,
+            High = 2
+        };
+
+        enum class Status {
+            // unknown handle, or its callback was already delivered
+            Unknown = 0,
+            Pending = 1,
+            Running = 2,
+            // done, callback not yet delivered
+            Completed = 3,
+            Cancelled = 4
+        };
+
+        struct Result {
+            Handle handle = 0;
+            // Completed or Cancelled
+            Status status = Status::Unknown;
+            // the Io call succeeded
+            bool success = false;
+            // read
+            std::vector<char> data;
+            // getDirList, findFiles
+            std::vector<Io::File> files;
+        };
+
+        typedef std::function<void(const Result &result)> Callback;
+
+        /// \param threads number of worker threads, io bound work doesn't need one per core
+        explicit AsyncIo(Io *io, int threads = 2);
+
+        virtual ~AsyncIo();
+
+        /// read "size" bytes at "offset" ("size" 0: the whole file) into Result::data
+        Handle read(const std::string &file, const Callback &callback,
+                    Priority priority = Priority::Normal, size_t size = 0, size_t offset = 0);
+
+        Handle write(const std::string &file, std::vector<char> data,
+                     const Callback &callback, Priority priority = Priority::Normal);
+
+        Handle copy(const std::string &src, const std::string &dst,
+                    const Callback &callback, Priority priority = Priority::Normal);
+
+        Handle getDirList(const std::string &path, bool sort, bool showHidden,
+                          const Callback &callback, Priority priority = Priority::Normal);
+
+        Handle findFiles(const std::string &path, const std::vector<std::string> &whitelist,
+                         const std::string &blacklist, bool stopOnFirst,
+                         const Callback &callback, Priority priority = Priority::Normal);
+
+        /// \return false if the request is unknown or already completed
+        bool cancel(Handle handle);
+
+        void cancelAll();
+
+        Status getStatus(Handle handle);
+
+        /// requests not yet completed (pending or running)
+        int getPending();
+
+        /// deliver the completion callbacks, on the calling thread. Returns the number delivered.
+        int dispatch();
+
+        /// block until every request is completed (callbacks are still delivered by dispatch)
+        void wait();
+
+    private:
+
+        enum class Op {
+            Read, Write, Copy, DirList, FindFiles
+        };
+
+        struct Request {
+            Handle handle = 0;
+            Op op = Op::Read;
+            Priority priority = Priority::Normal;
+            Status status = Status::Pending;
+            bool cancelled = false;
+            std::string path;
+            std::string path2;
+            std::vector<std::string> whitelist;
+            bool sort = false;
+            bool showHidden = false;
+            bool stopOnFirst = true;
+            size_t size = 0;
+            size_t offset = 0;
+            std::vector<char> data;
+            Callback callback;
+            Result result;
+        };
+
+        Handle submit(Request *request);
+
+        void run();
+
+        void execute(Request *request);
+
+        void complete(Request *request);
+
+        Io *m_io = nullptr;
+        ThreadPool *m_pool = nullptr;
+        Mutex *m_mutex = nullptr;
+        std::deque<Request *> m_queues[3];
+        std::vector<Request *> m_completed;
+        std::unordered_map<Handle, Request *> m_requests;
+        Handle m_next = 1;
+        int m_running = 0;
+        // being destroyed, new requests are cancelled right away
+        bool m_closing = false;
+    };
+}
+
+#endif //C2D_IO_ASYNC_H
@@ -0,0 +1,163 @@
+//
+// Created by cpasjuste on 17/10/2026.
+//
+
+#ifndef C2D_IO_CACHE_H
+#define C2D_IO_CACHE_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include "cross2d/skeleton/io.h"
+
+namespace c2d {
+
+    class Mutex;
+
+    /// Io decorator memoizing getDirList results by directory, everything else is forwarded
+    /// to the wrapped Io (owned). A cached directory is invalidated by inotify on linux/android,
+    /// elsewhere its modification time is checked on each access (instead of a listing).
+    /// Operations done through this Io (write, copy, remove...) invalidate their parent directory.
+    ///
+    /// The cache can be saved to a snapshot file and loaded back on the next run: a loaded
+    /// directory is only listed again if its modification time changed meanwhile. Note that
+    /// a file size change doesn't change its directory time, sizes may be stale after a load.
+    ///
+    /// Usage: renderer->setIo(new CachedIo(new C2DIo()));
+    class CachedIo : public Io {
+
+    public:
+
+        struct CacheStats {
+            unsigned long hits = 0;
+            unsigned long misses = 0;
+            unsigned long invalidations = 0;
+        };
+
+        explicit CachedIo(Io *io);
+
+        ~CachedIo() override;
+
+        Io *getIo();
+
+        std::string getRomFsPath() override;
+
+        std::string getDataPath() override;
+
+        void setDataPath(const std::string &path) override;
+
+        File getFile(const std::string &path) override;
+
+        bool exist(const std::string &path) override;
+
+        size_t getSize(const std::string &file) override;
+
+        Type getType(const std::string &file) override;
+
+        int64_t getModificationTime(const std::string &path) override;
+
+        bool create(const std::string &path) override;
+
+        bool removeFile(const std::string &path) override;
+
+        bool removeDir(const std::string &path) override;
+
+        bool copy(const std::string &src, const std::string &dst,
+                  const std::function<void(File, File, float)> &callback = nullptr) override;
+
+        std::vector<Io::File> getDirList(const std::string &path, bool sort = false, bool showHidden = false) override;
+
+        std::vector<File> findFiles(const std::string &path, const std::vector<std::string> &whitelist,
+                                    const std::string &blacklist = "", bool stopOnFirst = true) override;
+
+        /// not cached, forwarded to the wrapped Io
+        size_t findFilesRecursive(const std::string &path, const std::vector<std::string> &extensions,
+                                  const std::function<bool(const File &file)> &callback,
+                                  const std::string &blacklist = "") override;
+
+        size_t read(const std::string &file, char *out, size_t size = 0, size_t offset = 0) override;
+
+        bool write(const std::string &file, const char *data, size_t size) override;
+
+        Map *map(const std::string &file, Advice advice = Advice::Sequential) override;
+
+        bool isMappable(const std::string &file) override;
+
+        void setCopyThreads(int threads) override;
+
+        int getCopyThreads() override;
+
+        void setScanThreads(int threads) override;
+
+        int getScanThreads() override;
+
+        CopyStats getCopyStats() override;
+
+        void resetCopyStats() override;
+
+        ListStats getListStats() override;
+
+        void resetListStats() override;
+
+        void setDeferredStat(bool enable) override;
+
+        bool getDeferredStat() override;
+
+        bool resolve(File *file) override;
+
+        /// drop a directory from the cache
+        void invalidate(const std::string &path);
+
+        /// drop everything
+        void clear();
+
+        /// write the cached directories to "file"
+        bool saveSnapshot(const std::string &file);
+
+        /// load a snapshot written by saveSnapshot, entries are validated on first access
+        bool loadSnapshot(const std::string &file);
+
+        CacheStats getCacheStats();
+
+        static const uint32_t SnapshotVersion = 1;
+
+    private:
+
+        // one listing per getDirList (sort, showHidden) combination
+        struct Dir {
+            std::vector<File> lists[4];
+            bool listed[4] = {false, false, false, false};
+            int64_t mtime = -1;
+            int watch = -1;
+            // false for a directory loaded from a snapshot which was not checked yet
+            bool validated = true;
+        };
+
+        static std::string key(const std::string &path);
+
+        bool isValid(const std::string &path, Dir *dir);
+
+        void invalidateParent(const std::string &path);
+
+        void invalidateLocked(const std::string &path);
+
+        void clearLocked();
+
+        void readEvents();
+
+        void watch(const std::string &path, Dir *dir);
+
+        void unwatch(Dir *dir);
+
+        Io *m_io = nullptr;
+        Mutex *m_mutex = nullptr;
+        // ordered, so the sub directories of a path are a contiguous range (see invalidateParent)
+        std::map<std::string, Dir> m_dirs;
+        std::unordered_map<int, std::vector<std::string>> m_watches;
+        int m_inotify = -1;
+        CacheStats m_stats;
+    };
+}
+
+#endif //C2D_IO_CACHE_H
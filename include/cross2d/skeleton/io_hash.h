@@ -0,0 +1,129 @@
+//
+// Created by cpasjuste on 17/10/2026.
+//
+
+#ifndef C2D_IO_HASH_H
+#define C2D_IO_HASH_H
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <unordered_map>
+#include "cross2d/skeleton/io.h"
+
+// size of the reads used when a file is not mapped, and of the files always mapped (see compute)
+#define C2D_IO_HASH_CHUNK_SIZE (1024 * 1024)
+
+namespace c2d {
+
+    class Mutex;
+
+    class ThreadPool;
+
+    /// Computes CRC32 (zlib) and/or SHA1 of many files concurrently, for rom identification.
+    /// Files are read through the given Io (not owned), so archives mounted by a ZipIo can be
+    /// hashed too. Results are cached by path, validated by size and modification time:
+    /// with a cache loaded from a previous run, only new or changed files are read again.
+    ///
+    ///   IoHasher hasher(renderer->getIo());
+    ///   hasher.loadCache(io->getDataPath() + "hashes.bin");
+    ///   auto hashes = hasher.hash(files, IoHasher::Crc32 | IoHasher::Sha1);
+    ///   hasher.saveCache(io->getDataPath() + "hashes.bin");
+    class IoHasher {
+
+    public:
+
+        enum Algorithm {
+            Crc32 = 1,
+            Sha1 = 2
+        };
+
+        struct Hash {
+            std::string path;
+            size_t size = 0;
+            // see Io::getModificationTime
+            int64_t mtime = -1;
+            // computed algorithms
+            int algorithms = 0;
+            uint32_t crc = 0;
+            uint8_t sha1[20] = {};
+            // the file could be read
+            bool success = false;
+
+            /// lower case hexadecimal, empty if not computed
+            std::string getCrcString() const;
+
+            std::string getSha1String() const;
+        };
+
+        struct HashStats {
+            unsigned long hashed = 0;   // files read and hashed
+            unsigned long cached = 0;   // files served from the cache
+            uint64_t bytes = 0;         // bytes hashed
+            double seconds = 0;         // time spent in hash calls
+
+            double getBytesPerSecond() const {
+                return seconds > 0 ? (double) bytes / seconds : 0;
+            }
+        };
+
+        /// called for each file as soon as it is hashed. Calls are serialized (not concurrent)
+        /// and made with the hasher locked, the callback must not call the hasher.
+        typedef std::function<void(const Hash &hash, size_t done, size_t total)> Callback;
+
+        /// \param threads number of worker threads, 0 for "cpu count - 1" (at least one)
+        explicit IoHasher(Io *io, int threads = 0);
+
+        virtual ~IoHasher();
+
+        Hash hash(const std::string &file, int algorithms = Crc32);
+
+        /// hash "files" concurrently, results are returned in the same order
+        std::vector<Hash> hash(const std::vector<std::string> &files, int algorithms = Crc32,
+                               const Callback &callback = nullptr);
+
+        /// load a cache written by saveCache, entries are validated on use
+        bool loadCache(const std::string &file);
+
+        bool saveCache(const std::string &file);
+
+        void clearCache();
+
+        HashStats getStats();
+
+        void resetStats();
+
+        static uint32_t crc32(uint32_t crc, const uint8_t *data, size_t size);
+
+        static void sha1(const uint8_t *data, size_t size, uint8_t *digest);
+
+        static const uint32_t CacheVersion = 1;
+
+    private:
+
+        struct Sha1Context {
+            uint32_t state[5];
+            uint64_t length;
+            uint8_t buffer[64];
+            size_t used;
+        };
+
+        static void sha1Init(Sha1Context *ctx);
+
+        static void sha1Update(Sha1Context *ctx, const uint8_t *data, size_t size);
+
+        static void sha1Final(Sha1Context *ctx, uint8_t *digest);
+
+        static void sha1Transform(uint32_t *state, const uint8_t *block);
+
+        Hash compute(const std::string &file, int algorithms, std::vector<uint8_t> *buffer);
+
+        Io *m_io = nullptr;
+        ThreadPool *m_pool = nullptr;
+        Mutex *m_mutex = nullptr;
+        std::unordered_map<std::string, Hash> m_cache;
+        HashStats m_stats;
+    };
+}
+
+#endif //C2D_IO_HASH_H
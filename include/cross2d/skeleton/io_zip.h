@@ -0,0 +1,185 @@
+//
+// Created by cpasjuste on 17/10/2026.
+//
+
+#ifndef C2D_IO_ZIP_H
+#define C2D_IO_ZIP_H
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include "cross2d/skeleton/io.h"
+
+namespace c2d {
+
+    class Mutex;
+
+    /// Io decorator mounting a zip archive as a read only directory. Paths under the mount
+    /// point are served from the archive, everything else is forwarded to the wrapped Io (owned),
+    /// so loaders going through the renderer io (Texture, Font, BMFont, Config) read from
+    /// archives transparently:
+    ///
+    ///   renderer->setIo(new ZipIo(new C2DIo(), "skins/default.zip"));
+    ///   auto tex = new C2DTexture("skins/default.zip/title.png");
+    ///
+    /// The central directory is parsed once into a hash index (zip64 supported), listings
+    /// don't decompress anything. Deflated entries are inflated on demand (zlib), a read starting
+    /// where the previous one ended resumes its inflate (chunked reads stay linear), stored
+    /// entries are served from the archive mapping without copy when the platform can map it.
+    /// Other archives can be mounted by stacking ZipIo instances.
+    ///
+    /// Paths under the mount point which are not in the archive are forwarded too, so an archive
+    /// mounted over a directory overlays it (the packed romfs, see tools/romfs_pack.cpp).
+    /// Directories found in the archive are listed from the archive only.
+    class ZipIo : public Io {
+
+    public:
+
+        /// \param mountPoint path where the archive content appears, the archive path if empty
+        ZipIo(Io *io, const std::string &archive, const std::string &mountPoint = "");
+
+        ~ZipIo() override;
+
+        Io *getIo();
+
+        /// the archive was found and its central directory parsed
+        bool isOpen();
+
+        std::string getMountPoint();
+
+        /// number of entries, directories included (implied ones too)
+        size_t getEntryCount();
+
+        std::string getRomFsPath() override;
+
+        std::string getDataPath() override;
+
+        void setDataPath(const std::string &path) override;
+
+        File getFile(const std::string &path) override;
+
+        bool exist(const std::string &path) override;
+
+        size_t getSize(const std::string &file) override;
+
+        Type getType(const std::string &file) override;
+
+        /// entries modification time (local time, 2 seconds precision), the archive one for the root
+        int64_t getModificationTime(const std::string &path) override;
+
+        bool create(const std::string &path) override;
+
+        bool removeFile(const std::string &path) override;
+
+        bool removeDir(const std::string &path) override;
+
+        /// copy out of the archive is supported, into it is not
+        bool copy(const std::string &src, const std::string &dst,
+                  const std::function<void(File, File, float)> &callback = nullptr) override;
+
+        std::vector<Io::File> getDirList(const std::string &path, bool sort = false, bool showHidden = false) override;
+
+        std::vector<File> findFiles(const std::string &path, const std::vector<std::string> &whitelist,
+                                    const std::string &blacklist = "", bool stopOnFirst = true) override;
+
+        /// archives are walked from their index, a walk started outside of the mount point
+        /// is forwarded and doesn't enter the archive
+        size_t findFilesRecursive(const std::string &path, const std::vector<std::string> &extensions,
+                                  const std::function<bool(const File &file)> &callback,
+                                  const std::string &blacklist = "") override;
+
+        size_t read(const std::string &file, char *out, size_t size = 0, size_t offset = 0) override;
+
+        bool write(const std::string &file, const char *data, size_t size) override;
+
+        Map *map(const std::string &file, Advice advice = Advice::Sequential) override;
+
+        bool isMappable(const std::string &file) override;
+
+        void setCopyThreads(int threads) override;
+
+        int getCopyThreads() override;
+
+        void setScanThreads(int threads) override;
+
+        int getScanThreads() override;
+
+        CopyStats getCopyStats() override;
+
+        void resetCopyStats() override;
+
+        ListStats getListStats() override;
+
+        void resetListStats() override;
+
+        void setDeferredStat(bool enable) override;
+
+        bool getDeferredStat() override;
+
+        bool resolve(File *file) override;
+
+    private:
+
+        struct Entry {
+            std::string name;           // last path component
+            uint64_t offset = 0;        // local header offset
+            uint64_t compressedSize = 0;
+            uint64_t size = 0;
+            uint32_t crc = 0;
+            uint16_t method = 0;
+            // ms-dos date and time
+            uint16_t date = 0;
+            uint16_t time = 0;
+            bool directory = false;
+        };
+
+        // inflate state of a deflated entry read by consecutive chunks, see extract
+        struct Stream;
+
+        bool open();
+
+        bool readAt(uint64_t offset, void *dst, size_t size);
+
+        bool getDataOffset(const Entry &entry, uint64_t *offset);
+
+        size_t extract(const Entry &entry, uint8_t *out, size_t size, uint64_t offset);
+
+        void closeStream(Stream *stream);
+
+        void addEntry(const std::string &path, const Entry &entry);
+
+        size_t addDirectory(const std::string &path);
+
+        /// archive relative path of "path", false if it is outside the mount point or not in the archive
+        bool getInnerPath(const std::string &path, std::string *inner);
+
+        const Entry *find(const std::string &path);
+
+        File toFile(const std::string &inner, const Entry &entry);
+
+        bool copyEntry(const std::string &inner, const std::string &dst,
+                       const std::function<void(File, File, float)> &callback);
+
+        Io *m_io = nullptr;
+        std::string m_archive;
+        std::string m_mount;
+        uint64_t m_archive_size = 0;
+        // whole archive mapping, shared with the zero copy views (which may outlive this io)
+        std::shared_ptr<Io::Map> m_map;
+        // archive handle when it isn't mapped, reads are serialized by m_mutex
+        FILE *m_file = nullptr;
+        std::vector<Entry> m_entries;
+        // archive relative path (no trailing slash) -> entry, "" is the root
+        std::unordered_map<std::string, size_t> m_index;
+        // archive relative directory path -> children entries
+        std::unordered_map<std::string, std::vector<size_t>> m_children;
+        // streams left by the last chunked reads, most recent first
+        std::vector<Stream *> m_streams;
+        Mutex *m_mutex = nullptr;
+        bool m_open = false;
+    };
+}
+
+#endif //C2D_IO_ZIP_H
@@ -0,0 +1,96 @@
+//
+// Created by cpasjuste on 17/10/2026.
+//
+
+#ifndef C2D_MIXER_H
+#define C2D_MIXER_H
+
+#include <vector>
+#include <atomic>
+#include <cstdint>
+#include "audio_buffer.h"
+
+namespace c2d {
+
+    /// Software mixer for stereo S16 output, mixing voices on top of the Audio::play stream.
+    /// Voices are one-shot sample buffers or streams fed from another thread. Every voice
+    /// and mixing buffer is allocated up front: mix() never allocates nor locks,
+    /// it's meant to be called from the audio device callback (see Audio::setMixer).
+    class Mixer {
+
+    public:
+
+        /// \param voices maximum number of simultaneous voices
+        /// \param maxFrames mixing chunk size, larger requests are mixed in several passes
+        explicit Mixer(int voices = 16, int maxFrames = 4096);
+
+        virtual ~Mixer();
+
+        /// play a one-shot buffer of interleaved S16 samples (1 or 2 channels).
+        /// "samples" must stay valid until the voice has finished playing.
+        /// \return voice index, or -1 if no voice is available
+        virtual int play(const int16_t *samples, int frames, int channels = 2,
+                         float gain = 1.0f, float pan = 0.0f, bool loop = false);
+
+        /// open a stream voice, fed with push() (single producer thread)
+        /// \param capacity stream buffer capacity, in frames
+        /// \return voice index, or -1 if no voice is available
+        virtual int openStream(int capacity, int channels = 2, float gain = 1.0f, float pan = 0.0f);
+
+        /// queue interleaved S16 samples to a stream voice, returns false if they don't fit
+        virtual bool push(int voice, const int16_t *samples, int frames);
+
+        /// stop a voice (one-shot or stream), its slot is released by the next mix
+        virtual void stop(int voice);
+
+        virtual void stopAll();
+
+        virtual bool isPlaying(int voice);
+
+        virtual void setGain(int voice, float gain);
+
+        /// \param pan -1 (left) to 1 (right)
+        virtual void setPan(int voice, float pan);
+
+        virtual void setMasterGain(float gain);
+
+        /// mix the playing voices into "out" (interleaved stereo S16, "frames" frames).
+        /// "out" content is kept and mixed with the voices, with saturation.
+        virtual void mix(int16_t *out, int frames);
+
+    private:
+
+        enum State {
+            Free = 0,
+            Setup,
+            Playing,
+            Stopping
+        };
+
+        struct Voice {
+            std::atomic<int> state{Free};
+            std::atomic<float> gain{1.0f};
+            std::atomic<float> pan{0.0f};
+            int channels = 2;
+            // one-shot
+            const int16_t *samples = nullptr;
+            int frames = 0;
+            int position = 0;
+            bool loop = false;
+            // stream
+            SampleBuffer *stream = nullptr;
+        };
+
+        Voice *acquire();
+
+        void mixChunk(int16_t *out, int frames);
+
+        std::vector<Voice> m_voices;
+        std::vector<float> m_accum;
+        std::vector<int16_t> m_scratch;
+        std::atomic<float> m_master{1.0f};
+        int m_max_frames;
+    };
+}
+
+#endif //C2D_MIXER_H
@@ -18,6 +18,7 @@
 #include "cross2d/skeleton/sfml/Font.hpp"
 #include "cross2d/skeleton/input.h"
 #include "cross2d/skeleton/io.h"
+#include "cross2d/skeleton/io_async.h"
 
 #ifndef MAX_PATH
 #define MAX_PATH 512
@@ -29,6 +30,20 @@ namespace c2d {
 
     public:
 
+        static const int LatencyHistogramSize = 32;
+
+        // input to photon latency: from a button transition hardware time
+        // (Input::Event::time) to the end of the buffer swap of the frame which processed it
+        struct LatencyStats {
+            unsigned int events = 0;
+            float minMs = 0;
+            float maxMs = 0;
+            float avgMs = 0;
+            float avgFrames = 0;    // frames between the one observing the event and the swap (0: same frame)
+            // 2 ms buckets, the last one holds everything above
+            unsigned int histogram[LatencyHistogramSize] = {};
+        };
+
         explicit Renderer(const Vector2f &size = Vector2f(0, 0));
 
         ~Renderer() override;
@@ -66,10 +81,19 @@ namespace c2d {
         virtual Io *getIo() { return m_io; };
 
         virtual void setIo(Io *io) {
+            // pending requests use the previous io: they are cancelled, their callbacks delivered here
+            if (m_async_io) {
+                delete (m_async_io);
+                m_async_io = nullptr;
+            }
             if (m_io) { delete (m_io); }
             m_io = io;
         };
 
+        /// asynchronous access to getIo(), created on first use. Completion callbacks
+        /// are delivered on the render thread, at the start of each frame update (onUpdate)
+        virtual AsyncIo *getAsyncIo();
+
         virtual Font *getFont() { return m_font; };
 
         virtual void setFont(Font *font) {
@@ -88,14 +112,25 @@ namespace c2d {
             m_stats_print = enable;
         }
 
+        // latency measurement is disabled by default
+        void setLatencyStats(bool enable);
+
+        LatencyStats getLatencyStats();
+
+        void resetLatencyStats();
+
     protected:
 
         void onUpdate() override;
 
+        // to be called by the backends right after presenting a frame (buffer swap)
+        void onPresented();
+
         Color m_clearColor = Color::Black;
         bool m_process_inputs = true;
         Input *m_input = nullptr;
         Io *m_io = nullptr;
+        AsyncIo *m_async_io = nullptr;
         Font *m_font = nullptr;
         ShaderList *m_shaderList = nullptr;
         Clock *m_elapsedClock, *m_deltaClock, *m_fpsClock;
@@ -103,6 +138,17 @@ namespace c2d {
         float m_fps = 0;
         float m_frames = 0;
         bool m_stats_print = false;
+        // latency: input events observed and not yet presented
+        struct PendingEvent {
+            int64_t time;
+            unsigned int frame;
+        };
+        std::vector<PendingEvent> m_latency_pending;
+        LatencyStats m_latency;
+        double m_latency_sum_us = 0;
+        double m_latency_sum_frames = 0;
+        unsigned int m_frame = 0;
+        bool m_latency_enabled = false;
     };
 }
 
@@ -0,0 +1,83 @@
+//
+// Created by cpasjuste on 17/10/2026.
+//
+
+#ifndef C2D_RESAMPLER_H
+#define C2D_RESAMPLER_H
+
+#include <vector>
+#include <cstdint>
+
+namespace c2d {
+
+    /// Streaming sample rate converter for interleaved S16 audio (1 to 8 channels).
+    /// State is kept between process() calls so consecutive buffers join without
+    /// discontinuity. Buffers only grow, process() doesn't allocate once warmed up.
+    class Resampler {
+
+    public:
+
+        enum Quality {
+            // 2 taps, cheapest, audible aliasing/imaging
+            Linear = 0,
+            // 4 taps catmull-rom, a good default for low end devices
+            Cubic = 1,
+            // 32 taps blackman windowed sinc, polyphase table with interpolated phases
+            Sinc = 2
+        };
+
+        Resampler(int inputRate, int outputRate, int channels = 2, Quality quality = Cubic);
+
+        virtual ~Resampler() = default;
+
+        void setRates(int inputRate, int outputRate);
+
+        void setQuality(Quality quality);
+
+        Quality getQuality();
+
+        int getInputRate();
+
+        int getOutputRate();
+
+        /// resample "frames" input frames to "dst", returns the number of output frames.
+        /// "adjust" scales the output rate (used by Audio dynamic rate control, 1.0 otherwise).
+        /// "dst" must hold at least getMaxOutputFrames(frames, adjust) frames.
+        int process(const int16_t *src, int frames, int16_t *dst, double adjust = 1.0);
+
+        int getMaxOutputFrames(int frames, double adjust = 1.0);
+
+        /// drop the history (silence before the next process call) and the cost statistics
+        void reset();
+
+        /// average processing time, in milliseconds of cpu per second of output audio
+        float getCpuCost();
+
+        /// measure the cost of a quality tier on this device (about "seconds" of audio processed)
+        static float benchmark(Quality quality, int inputRate, int outputRate,
+                               int channels = 2, float seconds = 1.0f);
+
+    private:
+
+        void buildTable();
+
+        int taps();
+
+        int m_input_rate;
+        int m_output_rate;
+        int m_channels;
+        Quality m_quality;
+        // planar float history, m_history[channel][frame]
+        std::vector<std::vector<float>> m_history;
+        int m_history_frames = 0;
+        double m_position = 0;
+        // sinc polyphase table: (Phases + 1) rows of SincTaps coefficients
+        std::vector<float> m_table;
+        std::vector<float> m_coefs;
+        // cost
+        int64_t m_cost_ns = 0;
+        int64_t m_cost_frames = 0;
+    };
+}
+
+#endif //C2D_RESAMPLER_H
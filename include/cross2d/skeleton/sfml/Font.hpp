@@ -146,6 +146,38 @@ namespace c2d {
         virtual const Glyph &getGlyph(uint32_t codePoint, unsigned int characterSize,
                                       bool bold, float outlineThickness = 0) const;
 
+        ////////////////////////////////////////////////////////////
+        /// \brief Rasterize a set of glyphs in the background
+        ///
+        /// Glyphs are rasterized in parallel by a worker pool shared by
+        /// all the fonts, each worker using its own FreeType face of
+        /// the font file. The resulting bitmaps are packed and uploaded to the glyphs
+        /// texture by the calling (render) thread, either when getGlyph
+        /// first needs them, when flushGlyphs is called, or before
+        /// returning if \a wait is true.
+        ///
+        /// \param codePoints       Unicode code points of the characters to rasterize
+        /// \param characterSize    Reference character size
+        /// \param bold             Rasterize the bold version or the regular one?
+        /// \param outlineThickness Thickness of outline
+        /// \param wait             Block until all glyphs are rasterized and uploaded
+        ///
+        /// \see flushGlyphs
+        ///
+        ////////////////////////////////////////////////////////////
+        virtual void preloadGlyphs(const std::u32string &codePoints, unsigned int characterSize,
+                                   bool bold = false, float outlineThickness = 0, bool wait = false);
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Upload glyphs already rasterized in the background
+        ///
+        /// Must be called from the render thread.
+        ///
+        /// \see preloadGlyphs
+        ///
+        ////////////////////////////////////////////////////////////
+        virtual void flushGlyphs();
+
         ////////////////////////////////////////////////////////////
         /// \brief Get the kerning offset of two glyphs
         ///
@@ -220,6 +252,54 @@ namespace c2d {
         ////////////////////////////////////////////////////////////
         virtual Texture *getTexture(unsigned int characterSize);
 
+        ////////////////////////////////////////////////////////////
+        /// \brief Retrieve a page texture of a given character size
+        ///
+        /// Glyphs are packed into fixed size pages, see Glyph::page.
+        ///
+        /// \param characterSize Reference character size
+        /// \param page          Index of the page
+        ///
+        /// \return Texture of the page, or nullptr if it doesn't exist
+        ///
+        ////////////////////////////////////////////////////////////
+        virtual Texture *getPageTexture(unsigned int characterSize, unsigned int page);
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Get the pages generation of a given character size
+        ///
+        /// The generation is incremented each time a page is evicted to
+        /// make room for new glyphs: texture rectangles of glyphs
+        /// previously returned by getGlyph are then invalid.
+        ///
+        /// \param characterSize Reference character size
+        ///
+        /// \return Current generation
+        ///
+        ////////////////////////////////////////////////////////////
+        virtual unsigned int getGeneration(unsigned int characterSize) const;
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Set the size of the glyphs pages textures
+        ///
+        /// Only affects pages created after the call.
+        ///
+        /// \param size Size of a page texture
+        ///
+        ////////////////////////////////////////////////////////////
+        virtual void setPageSize(const Vector2i &size);
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Set the maximum number of pages per character size
+        ///
+        /// When the limit is reached, the least recently used page
+        /// is evicted to make room for new glyphs.
+        ///
+        /// \param maxPages Maximum number of pages (0 for unlimited)
+        ///
+        ////////////////////////////////////////////////////////////
+        virtual void setMaxPages(unsigned int maxPages);
+
         virtual void setFilter(Texture::Filter filter);
 
         virtual Texture::Filter getFilter();
@@ -237,15 +317,16 @@ namespace c2d {
     private:
 
         ////////////////////////////////////////////////////////////
-        /// \brief Structure defining a row of glyphs
+        /// \brief Structure defining a segment of a page skyline
         ///
         ////////////////////////////////////////////////////////////
-        struct Row {
-            Row(unsigned int rowTop, unsigned int rowHeight) : width(0), top(rowTop), height(rowHeight) {}
+        struct SkylineNode {
+            SkylineNode(unsigned int nodeX, unsigned int nodeY, unsigned int nodeWidth)
+                    : x(nodeX), y(nodeY), width(nodeWidth) {}
 
-            unsigned int width;  ///< Current width of the row
-            unsigned int top;    ///< Y position of the row into the texture
-            unsigned int height; ///< Height of the row
+            unsigned int x;     ///< X position of the segment into the texture
+            unsigned int y;     ///< Height of the skyline over the segment
+            unsigned int width; ///< Width of the segment
         };
 
         ////////////////////////////////////////////////////////////
@@ -254,18 +335,35 @@ namespace c2d {
         typedef std::map<uint64_t, Glyph> GlyphTable; ///< Table mapping a codepoint to its glyph
 
         ////////////////////////////////////////////////////////////
-        /// \brief Structure defining a page of glyphs
+        /// \brief Structure defining a page (texture) of glyphs
         ///
         ////////////////////////////////////////////////////////////
         struct Page {
-            Page();
+            explicit Page(const Vector2i &size);
 
             ~Page();
 
-            GlyphTable glyphs;  ///< Table mapping code points to their corresponding glyph
-            Texture *texture = nullptr; ///< Texture containing the pixels of the glyphs
-            unsigned int nextRow; ///< Y position of the next new row in the texture
-            std::vector<Row> rows;    ///< List containing the position of all the existing rows
+            Texture *texture = nullptr;        ///< Texture containing the pixels of the glyphs
+            std::vector<SkylineNode> skyline;  ///< Skyline of the packed glyphs, from left to right
+            uint64_t lastUse = 0;              ///< Use counter value of the last lookup hitting this page
+        };
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Structure defining the pages of a character size
+        ///
+        ////////////////////////////////////////////////////////////
+        struct Atlas {
+            Atlas() = default;
+
+            Atlas(const Atlas &) = delete;
+
+            Atlas &operator=(const Atlas &) = delete;
+
+            ~Atlas();
+
+            GlyphTable glyphs;         ///< Table mapping code points to their corresponding glyph
+            std::vector<Page *> pages; ///< Pages holding the glyphs pixels
+            unsigned int generation = 0; ///< Incremented each time a page is evicted
         };
 
         ////////////////////////////////////////////////////////////
@@ -288,6 +386,21 @@ namespace c2d {
         virtual Glyph loadGlyph(uint32_t codePoint, unsigned int characterSize,
                                 bool bold, float outlineThickness) const;
 
+        ////////////////////////////////////////////////////////////
+        /// \brief Pack a rasterized glyph into the page texture
+        ///
+        /// \param glyph         Glyph metrics, as returned by the rasterizer
+        /// \param characterSize Reference character size
+        /// \param coverage      8 bits coverage values (width * height)
+        /// \param width         Width of the coverage bitmap
+        /// \param height        Height of the coverage bitmap
+        ///
+        /// \return The glyph with its texture rectangle set
+        ///
+        ////////////////////////////////////////////////////////////
+        virtual Glyph writeGlyph(Glyph glyph, unsigned int characterSize,
+                                 const uint8_t *coverage, unsigned int width, unsigned int height) const;
+
         ////////////////////////////////////////////////////////////
         /// \brief Find a suitable rectangle within the texture for a glyph
         ///
@@ -300,6 +413,24 @@ namespace c2d {
         ////////////////////////////////////////////////////////////
         virtual IntRect findGlyphRect(Page &page, unsigned int width, unsigned int height) const;
 
+        ////////////////////////////////////////////////////////////
+        /// \brief Find a rectangle for a glyph in any page of an atlas
+        ///
+        /// Existing pages are tried first, then a new page is added
+        /// if the pages limit allows it, otherwise the least recently
+        /// used page is evicted and reused.
+        ///
+        /// \param atlas  Atlas of the character size
+        /// \param width  Width of the rectangle
+        /// \param height Height of the rectangle
+        /// \param page   Receives the index of the page holding the rectangle
+        ///
+        /// \return Found rectangle, or an empty one on failure
+        ///
+        ////////////////////////////////////////////////////////////
+        virtual IntRect allocGlyphRect(Atlas &atlas, unsigned int width, unsigned int height,
+                                       unsigned int *page) const;
+
         ////////////////////////////////////////////////////////////
         /// \brief Make sure that the given size is the current one
         ///
@@ -313,7 +444,7 @@ namespace c2d {
         ////////////////////////////////////////////////////////////
         // Types
         ////////////////////////////////////////////////////////////
-        typedef std::map<unsigned int, Page> PageTable; ///< Table mapping a character size to its page (texture)
+        typedef std::map<unsigned int, Atlas> AtlasTable; ///< Table mapping a character size to its pages
 
         ////////////////////////////////////////////////////////////
         // Member data
@@ -322,14 +453,20 @@ namespace c2d {
         void *m_face;        ///< Pointer to the internal font face (it is typeless to avoid exposing implementation details)
         void *m_streamRec;   ///< Pointer to the stream rec instance (it is typeless to avoid exposing implementation details)
         void *m_stroker;     ///< Pointer to the stroker (it is typeless to avoid exposing implementation details)
+        void *m_rasterizer;  ///< Pointer to the background glyphs rasterizer (it is typeless to avoid exposing implementation details)
+        void *m_file;        ///< Pointer to the shared font file, when loaded from file (it is typeless to avoid exposing implementation details)
+        const void *m_data;  ///< Font data, shared with the rasterizer faces
+        std::size_t m_dataSize; ///< Font data size, in bytes
         int *m_refCount;    ///< Reference counter used by implicit sharing
         Info m_info;        ///< Information about the font
-        mutable PageTable m_pages;       ///< Table containing the glyphs pages by character size
+        mutable AtlasTable m_atlases;    ///< Table containing the glyphs pages by character size
+        Vector2i m_pageSize;        ///< Size of the pages textures
+        unsigned int m_maxPages;    ///< Maximum number of pages per character size (0 for unlimited)
+        mutable uint64_t m_useCounter; ///< Counter used to track the pages usage
         mutable std::vector<uint8_t> m_pixelBuffer; ///< Pixel buffer holding a glyph's pixels before being written to the texture
         Texture::Filter m_filtering = Texture::Filter::Linear;
         Vector2f m_offset;
         std::string m_font_path;
-		std::string m_buff;
     };
 
 } // namespace c2d
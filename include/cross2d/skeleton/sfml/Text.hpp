@@ -97,6 +97,8 @@ namespace c2d {
         explicit Text(const std::string &string,
                       unsigned int characterSize = C2D_DEFAULT_CHAR_SIZE, Font *font = nullptr);
 
+        ~Text() override;
+
         ////////////////////////////////////////////////////////////
         /// \brief Set the text's string
         ///
@@ -386,6 +388,21 @@ namespace c2d {
         ////////////////////////////////////////////////////////////
         void ensureGeometryUpdate() const;
 
+        ////////////////////////////////////////////////////////////
+        /// \brief Build the text's geometry from the current font pages
+        ///
+        ////////////////////////////////////////////////////////////
+        void buildGeometry() const;
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Get the vertex array holding the glyphs of a font page
+        ///
+        /// \param page    Index of the font page
+        /// \param outline Get the outline geometry instead of the fill one
+        ///
+        ////////////////////////////////////////////////////////////
+        VertexArray &getPageVertices(unsigned int page, bool outline) const;
+
         ////////////////////////////////////////////////////////////
         // Member data
         ////////////////////////////////////////////////////////////
@@ -399,6 +416,9 @@ namespace c2d {
         float m_outlineThickness;   ///< Thickness of the text's outline
         mutable c2d::VertexArray m_vertices;           ///< Vertex array containing the fill geometry
         mutable c2d::VertexArray m_outlineVertices;    ///< Vertex array containing the outline geometry
+        mutable std::vector<c2d::VertexArray *> m_pageVertices;        ///< Fill geometry of the next font pages
+        mutable std::vector<c2d::VertexArray *> m_pageOutlineVertices; ///< Outline geometry of the next font pages
+        mutable unsigned int m_generation = 0; ///< Font pages generation the geometry was built with
         mutable c2d::FloatRect m_bounds;             ///< Bounding rectangle of the text (in local coordinates)
         mutable bool m_geometryNeedUpdate; ///< Does the geometry need to be recomputed?
         mutable c2d::Vector2f m_max_size = {4096, 4096};
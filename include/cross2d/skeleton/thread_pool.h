@@ -0,0 +1,66 @@
+//
+// Created by cpasjuste on 17/10/2026.
+//
+
+#ifndef C2D_THREAD_POOL_H
+#define C2D_THREAD_POOL_H
+
+#include <deque>
+#include <vector>
+#include <functional>
+
+namespace c2d {
+
+    class Thread;
+
+    class Mutex;
+
+    class Cond;
+
+    class ThreadPool {
+
+    public:
+
+        /// a task receive the index of the worker running it,
+        /// so callers can keep per-worker state (0 <= worker < getThreadCount())
+        typedef std::function<void(int worker)> Task;
+
+        /// \param threads number of worker threads, 0 for "cpu count - 1" (at least one).
+        /// On platforms without thread/cond support, tasks are run synchronously on push.
+        explicit ThreadPool(int threads = 0);
+
+        virtual ~ThreadPool();
+
+        virtual void push(const Task &task);
+
+        /// block until every pushed task has completed
+        virtual void wait();
+
+        /// drop tasks which are not yet running
+        virtual void clear();
+
+        int getThreadCount() const;
+
+        int getPending();
+
+    private:
+
+        struct Worker {
+            ThreadPool *pool = nullptr;
+            Thread *thread = nullptr;
+            int index = 0;
+        };
+
+        static int workerThread(void *data);
+
+        std::vector<Worker> m_workers;
+        std::deque<Task> m_tasks;
+        Mutex *m_mutex = nullptr;
+        Cond *m_cond = nullptr;
+        Cond *m_idle_cond = nullptr;
+        int m_busy = 0;
+        bool m_quit = false;
+    };
+}
+
+#endif //C2D_THREAD_POOL_H
@@ -9,6 +9,8 @@
 #include <vector>
 #include <random>
 #include <ctime>
+#include <cstdio>
+#include <cstdint>
 
 namespace c2d {
 
@@ -56,6 +58,23 @@ namespace c2d {
         static int getCharacterBytes(unsigned char firstByte);
 
         static int getCharacterNum(std::string &str);
+
+        // Decode an UTF-8 string to UTF-32, with a fast path for ASCII runs.
+        // Invalid or truncated sequences are replaced by "replacement", one per bad byte.
+        // "dst" must hold at least "len" code points, returns the number of code points written.
+        // With a null "dst", the code points are only counted.
+        static size_t utf8ToUtf32(const char *src, size_t len, char32_t *dst, char32_t replacement = 0xFFFD);
+
+        static std::u32string utf8ToUtf32(const std::string &str, char32_t replacement = 0xFFFD);
+
+        // Little endian integers of the c2d binary files (caches, records...): the "bytes"
+        // (1 to 8) low bytes of "value". readLE returns false on a short read.
+        static void writeLE(FILE *file, uint64_t value, int bytes);
+
+        static bool readLE(FILE *file, uint64_t *value, int bytes);
+
+        // Monotonic clock, in microseconds (arbitrary origin)
+        static int64_t getTimeUs();
     };
 }
 
@@ -38,16 +38,27 @@ static int audioThread(void *data) {
             if (s_waveBufs[i].status != NDSP_WBUF_DONE) {
                 continue;
             }
+            // the channel is paused too, don't queue silence ahead of the next samples
+            if (audio->isPaused()) {
+                break;
+            }
+            // a played buffer is our "device callback": always queue one back so the
+            // channel keeps its pace, with silence when not enough samples were pushed
             ndspWaveBuf *waveBuf = &s_waveBufs[i];
-            if (audio->getSampleBufferQueued() >= audio->getSamplesSize() >> 1) {
-                audio->lock();
-                audio->getSampleBuffer()->pull((int16_t *) waveBuf->data_pcm16, audio->getSamplesSize() >> 1);
-                audio->unlock();
-                // Pass samples to NDSP
-                waveBuf->nsamples = audio->getSamples();
-                ndspChnWaveBufAdd(0, waveBuf);
-                DSP_FlushDataCache(waveBuf->data_pcm16, audio->getSamplesSize());
+            audio->recordCallback();
+            if (audio->getSampleBuffer()->pull((int16_t *) waveBuf->data_pcm16, audio->getSamplesSize() >> 1)) {
+                audio->notify();
+            } else {
+                memset(waveBuf->data_pcm16, 0, audio->getSamplesSize());
+                audio->recordUnderrun();
+            }
+            if (Mixer *mixer = audio->getMixer()) {
+                mixer->mix((int16_t *) waveBuf->data_pcm16, audio->getSamples());
             }
+            // Pass samples to NDSP
+            waveBuf->nsamples = audio->getSamples();
+            ndspChnWaveBufAdd(0, waveBuf);
+            DSP_FlushDataCache(waveBuf->data_pcm16, audio->getSamplesSize());
         }
 
         // Wait for a signal that we're needed again before continuing,
@@ -22,9 +22,17 @@ static void *audioCb(snd_stream_hnd_t hnd, int smp_req, int *smp_recv) {
 #else
     auto *audio = (DCAudio *) snd_stream_get_userdata(hnd);
 #endif
-    audio->lock();
-    audio->getSampleBuffer()->pull(dc_buf, smp_req >> 1);
-    audio->unlock();
+    audio->recordCallback();
+    if (audio->getSampleBuffer()->pull(dc_buf, smp_req >> 1)) {
+        audio->notify();
+    } else {
+        memset(dc_buf, 0, smp_req);
+        audio->recordUnderrun();
+    }
+
+    if (Mixer *mixer = audio->getMixer()) {
+        mixer->mix(dc_buf, (smp_req >> 1) / audio->getChannels());
+    }
     *smp_recv = smp_req;
 
     return dc_buf;
@@ -45,7 +53,7 @@ static int audioThread(void *data) {
 
     while (audio->isAvailable()) {
         while (audio->isAvailable() &&
-               (audio->isPaused() || audio->getSampleBufferQueued() < audio->getSamplesSize() >> 1)) {
+               (audio->isPaused() || audio->getSampleBuffer()->space_readable() < audio->getSamplesSize() >> 1)) {
             //printf("audioCb: req: %i, filled: %i\n", smp_req, filled);
             thd_pass();
         }
@@ -74,9 +82,7 @@ void DCAudio::pause(int pause) {
     Audio::pause(pause);
     if (pause) {
         snd_stream_stop(stream_hnd);
-        lock();
         memset(dc_buf, 0, getSamplesSize());
-        unlock();
     } else {
         snd_stream_start(stream_hnd, getSampleRate(), getChannels() - 1);
     }
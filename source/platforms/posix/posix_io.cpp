@@ -6,6 +6,7 @@
 #include <cstring>
 #include <dirent.h>
 #include <sys/stat.h>
+#include <set>
 
 #include "cross2d/c2d.h"
 
@@ -16,8 +17,82 @@
 #define rmdir(x) sceIoRmdir(x)
 #endif
 
+#if defined(__LINUX__) || defined(__ANDROID__) || defined(__APPLE__)
+#define C2D_IO_FSTATAT
+#define C2D_IO_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#endif
+
+#if defined(__LINUX__) || defined(__ANDROID__)
+// kernel side copies, no round trip through a user buffer
+#define C2D_IO_SENDFILE
+#include <sys/sendfile.h>
+#ifdef __LINUX__
+#define C2D_IO_COPY_FILE_RANGE
+#endif
+#endif
+
+// bytes per kernel copy call, so progress can be reported while copying big files
+#define C2D_IO_COPY_CHUNK_SIZE (8 * 1024 * 1024)
+
 using namespace c2d;
 
+#ifdef C2D_IO_MMAP
+
+class POSIXMap : public Io::Map {
+public:
+    POSIXMap(void *data, size_t size) {
+        m_data = (const uint8_t *) data;
+        m_size = size;
+        m_mapped = true;
+    }
+
+    ~POSIXMap() override {
+        munmap((void *) m_data, m_size);
+    }
+};
+
+#endif
+
+// fill a listed entry type (and size), file name and path must be set.
+// The type comes from the directory entry when available, stat is only called when
+// it's needed (links, filesystems without d_type) or when not deferred. Returns true if stat was called.
+static bool readEntry(DIR *dir, const struct dirent *ent, Io::File *file, bool deferred) {
+    bool needStat = !deferred;
+#ifdef DT_DIR
+    if (ent->d_type == DT_DIR) {
+        file->type = Io::Type::Directory;
+    } else if (ent->d_type == DT_REG) {
+        file->type = Io::Type::File;
+    } else {
+        needStat = true;
+    }
+#else
+    needStat = true;
+#endif
+
+    if (!needStat) {
+        file->resolved = file->type == Io::Type::Directory;
+        return false;
+    }
+
+    struct stat st{};
+#ifdef C2D_IO_FSTATAT
+    // relative to the open directory, no path walk per entry
+    int res = fstatat(dirfd(dir), ent->d_name, &st, 0);
+#else
+    int res = stat(file->path.c_str(), &st);
+#endif
+    if (res == 0) {
+        file->size = (size_t) st.st_size;
+        file->type = S_ISDIR(st.st_mode) ? Io::Type::Directory : Io::Type::File;
+    }
+    file->resolved = true;
+
+    return true;
+}
+
 std::string POSIXIo::getRomFsPath() {
 #if defined(__WINDOWS__) || defined(__LINUX__) || defined(__PROSPERO__)
     return getDataPath() + "data_romfs/";
@@ -152,6 +227,21 @@ Io::Type POSIXIo::getType(const std::string &file) {
     return S_ISDIR(st.st_mode) ? Type::Directory : Type::File;
 }
 
+int64_t POSIXIo::getModificationTime(const std::string &path) {
+    struct stat st{};
+    if (stat(path.c_str(), &st) != 0) {
+        return -1;
+    }
+
+    auto time = (int64_t) st.st_mtime * 1000000000;
+#if defined(__LINUX__) || defined(__ANDROID__)
+    time += st.st_mtim.tv_nsec;
+#elif defined(__APPLE__)
+    time += st.st_mtimespec.tv_nsec;
+#endif
+    return time;
+}
+
 size_t POSIXIo::read(const std::string &file, char *out, size_t size, const size_t offset) {
     FILE *fp = fopen(file.c_str(), "rb");
     if (fp == nullptr) {
@@ -188,6 +278,52 @@ size_t POSIXIo::read(const std::string &file, char *out, size_t size, const size
     return read_size;
 }
 
+Io::Map *POSIXIo::map(const std::string &file, Advice advice) {
+#ifdef C2D_IO_MMAP
+    int fd = open(file.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return nullptr;
+    }
+
+    struct stat st{};
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return nullptr;
+    }
+
+    auto size = (size_t) st.st_size;
+    void *data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+        close(fd);
+        // some filesystems (fuse, network...) can't be mapped
+        return Io::map(file, advice);
+    }
+
+    int madv = advice == Advice::Sequential ? MADV_SEQUENTIAL : advice == Advice::Random ? MADV_RANDOM : MADV_NORMAL;
+    madvise(data, size, madv);
+#if defined(__LINUX__) || defined(__ANDROID__)
+    // page cache read ahead, MADV_SEQUENTIAL only affects the mapping
+    int fadv = advice == Advice::Sequential ? POSIX_FADV_SEQUENTIAL
+                                            : advice == Advice::Random ? POSIX_FADV_RANDOM : POSIX_FADV_NORMAL;
+    posix_fadvise(fd, 0, 0, fadv);
+#endif
+    // the mapping stays valid after closing the descriptor
+    close(fd);
+
+    return new POSIXMap(data, size);
+#else
+    return Io::map(file, advice);
+#endif
+}
+
+bool POSIXIo::isMappable(const std::string &file) {
+#ifdef C2D_IO_MMAP
+    return true;
+#else
+    return false;
+#endif
+}
+
 bool POSIXIo::write(const std::string &file, const char *data, size_t size) {
     FILE *fp;
 
@@ -202,10 +338,29 @@ bool POSIXIo::write(const std::string &file, const char *data, size_t size) {
     return true;
 }
 
+bool POSIXIo::resolve(File *file) {
+    if (file->resolved) {
+        return true;
+    }
+
+    struct stat st{};
+    if (stat(file->path.c_str(), &st) != 0) {
+        return false;
+    }
+
+    file->size = (size_t) st.st_size;
+    file->type = S_ISDIR(st.st_mode) ? Type::Directory : Type::File;
+    file->resolved = true;
+
+    return true;
+}
+
 std::vector<Io::File> POSIXIo::getDirList(const std::string &path, bool sort, bool showHidden) {
     std::vector<Io::File> files;
     struct dirent *ent;
     DIR *dir;
+    int64_t start = Utility::getTimeUs();
+    unsigned long stats = 0;
 
     if (!path.empty()) {
         if ((dir = opendir(path.c_str())) != nullptr) {
@@ -225,18 +380,7 @@ std::vector<Io::File> POSIXIo::getDirList(const std::string &path, bool sort, bo
                 File file;
                 file.name = ent->d_name;
                 file.path = Utility::removeLastSlash(path) + "/" + file.name;
-#if 0
-                auto *dirSt = (fsdev_dir_t *) dir->dirData->dirStruct;
-                FsDirectoryEntry *entry = &dirSt->entry_data[dirSt->index];
-                file.type = entry->type == ENTRYTYPE_DIR ? Type::Directory : Type::File;
-                file.size = entry->fileSize;
-#else
-                struct stat st{};
-                if (stat(file.path.c_str(), &st) == 0) {
-                    file.size = (size_t) st.st_size;
-                    file.type = S_ISDIR(st.st_mode) ? Type::Directory : Type::File;
-                }
-#endif
+                stats += readEntry(dir, ent, &file, m_deferred_stat);
                 files.push_back(file);
             }
             closedir(dir);
@@ -246,6 +390,11 @@ std::vector<Io::File> POSIXIo::getDirList(const std::string &path, bool sort, bo
         }
     }
 
+    m_list_count++;
+    m_list_entries += files.size();
+    m_list_stats += stats;
+    m_list_us += Utility::getTimeUs() - start;
+
     return files;
 }
 
@@ -254,6 +403,8 @@ std::vector<Io::File> POSIXIo::findFiles(const std::string &path, const std::vec
     struct dirent *ent;
     DIR *dir;
     std::vector<Io::File> files{};
+    int64_t start = Utility::getTimeUs();
+    unsigned long stats = 0;
 
     if (path.empty()) {
         return files;
@@ -269,19 +420,7 @@ std::vector<Io::File> POSIXIo::findFiles(const std::string &path, const std::vec
                     Io::File file;
                     file.name = ent->d_name;
                     file.path = Utility::removeLastSlash(path) + "/" + file.name;
-#if 0
-
-                    auto *dirSt = (fsdev_dir_t *) dir->dirData->dirStruct;
-                    FsDirectoryEntry *entry = &dirSt->entry_data[dirSt->index];
-                    file.type = entry->type == ENTRYTYPE_DIR ? Type::Directory : Type::File;
-                    file.size = entry->fileSize;
-#else
-                    struct stat st{};
-                    if (stat(file.path.c_str(), &st) == 0) {
-                        file.size = (size_t) st.st_size;
-                        file.type = S_ISDIR(st.st_mode) ? Type::Directory : Type::File;
-                    }
-#endif
+                    stats += readEntry(dir, ent, &file, m_deferred_stat);
                     files.emplace_back(file);
                     if (stopOnFirst) break;
                     else continue;
@@ -291,12 +430,130 @@ std::vector<Io::File> POSIXIo::findFiles(const std::string &path, const std::vec
         closedir(dir);
     }
 
+    m_list_count++;
+    m_list_entries += files.size();
+    m_list_stats += stats;
+    m_list_us += Utility::getTimeUs() - start;
+
     return files;
 }
 
+size_t POSIXIo::findFilesRecursive(const std::string &path, const std::vector<std::string> &extensions,
+                                   const std::function<bool(const File &file)> &callback,
+                                   const std::string &blacklist) {
+    if (path.empty()) {
+        return 0;
+    }
+
+    int64_t start = Utility::getTimeUs();
+    const ExtensionSet set(extensions);
+    Mutex *mutex = new C2DMutex();
+    auto pool = new ThreadPool(m_scan_threads);
+    std::set<std::pair<uint64_t, uint64_t>> visited;
+    std::atomic<bool> stop{false};
+    std::atomic<unsigned long> lists{0}, stats{0};
+    size_t found = 0;
+
+    // each directory is a pool task, its subdirectories are pushed to the pool once it is closed:
+    // without C2DCond the pool runs them inline, it must not keep a handle open per depth level
+    std::function<void(const std::string &)> scan = [&](const std::string &dirPath) {
+        DIR *dir;
+        struct dirent *ent;
+        if (stop || (dir = opendir(dirPath.c_str())) == nullptr) {
+            return;
+        }
+#ifdef C2D_IO_FSTATAT
+        // don't loop on symbolic links to a parent directory
+        struct stat st{};
+        if (fstat(dirfd(dir), &st) == 0) {
+            mutex->lock();
+            bool seen = !visited.insert({(uint64_t) st.st_dev, (uint64_t) st.st_ino}).second;
+            mutex->unlock();
+            if (seen) {
+                closedir(dir);
+                return;
+            }
+        }
+#endif
+        lists++;
+
+        std::string prefix = Utility::removeLastSlash(dirPath) + "/";
+        std::vector<Io::File> files;
+        std::vector<std::string> dirs;
+        while (!stop && (ent = readdir(dir)) != nullptr) {
+            // hidden entries, "." and ".."
+            if (ent->d_name[0] == '.') {
+                continue;
+            }
+            if (!blacklist.empty() && Utility::contains(ent->d_name, blacklist)) {
+                continue;
+            }
+            bool match = set.match(ent->d_name);
+#ifdef DT_DIR
+            // not wanted, and known not to be a directory: no need to build it
+            if (!match && ent->d_type == DT_REG) {
+                continue;
+            }
+#endif
+            Io::File file;
+            file.name = ent->d_name;
+            file.path = prefix + file.name;
+            stats += readEntry(dir, ent, &file, m_deferred_stat);
+            if (file.type == Type::Directory) {
+                dirs.push_back(file.path);
+            } else if (match && file.type == Type::File) {
+                files.push_back(file);
+            }
+        }
+        closedir(dir);
+
+        // delivered by directory, one lock per directory instead of one per file
+        mutex->lock();
+        for (size_t i = 0; i < files.size() && !stop; i++) {
+            found++;
+            if (!callback(files[i])) {
+                stop = true;
+            }
+        }
+        mutex->unlock();
+
+        for (size_t i = 0; i < dirs.size() && !stop; i++) {
+            pool->push([&scan, dir = dirs[i]](int) {
+                scan(dir);
+            });
+        }
+    };
+
+    pool->push([&scan, &path](int) {
+        scan(path);
+    });
+    pool->wait();
+    delete (pool);
+    delete (mutex);
+
+    m_list_count += lists;
+    m_list_entries += found;
+    m_list_stats += stats;
+    m_list_us += Utility::getTimeUs() - start;
+
+    return found;
+}
+
 bool POSIXIo::copy(const std::string &src, const std::string &dst,
                    const std::function<void(File, File, float)> &callback) {
-    bool res = _copy(src, dst, callback);
+    int64_t start = Utility::getTimeUs();
+
+    // directories are created while walking the source, files are copied after
+    std::vector<std::pair<File, File>> files;
+    bool res = _copy(src, dst, callback, &files);
+    if (res) {
+        res = _copyFiles(files, callback);
+        if (res && files.size() == 1 && files[0].first.path == src && callback != nullptr) {
+            callback(files[0].first, files[0].second, 2);
+        }
+    }
+
+    m_copy_us += Utility::getTimeUs() - start;
 
     if (callback != nullptr) {
         callback(File{}, File{}, res ? 2 : -1);
@@ -306,7 +563,8 @@ bool POSIXIo::copy(const std::string &src, const std::string &dst,
 }
 
 bool POSIXIo::_copy(const std::string &src, const std::string &dst,
-                    const std::function<void(File, File, float)> &callback) {
+                    const std::function<void(File, File, float)> &callback,
+                    std::vector<std::pair<File, File>> *files) {
     File srcFile;
     File dstFile;
     struct dirent *ent;
@@ -339,11 +597,8 @@ bool POSIXIo::_copy(const std::string &src, const std::string &dst,
     dstFile.path += dstFile.name;
 
     if (srcFile.type == Type::File) {
-        bool res = _copyFile(srcFile, dstFile, callback);
-        if (callback != nullptr) {
-            callback(srcFile, dstFile, 2);
-        }
-        return res;
+        files->emplace_back(srcFile, dstFile);
+        return true;
     }
 
     if (!create(dstFile.path)) {
@@ -368,16 +623,9 @@ bool POSIXIo::_copy(const std::string &src, const std::string &dst,
             if (newSrcFile.type == Type::File) {
                 newDstFile.path += (Utility::endsWith(dstFile.path, "/") ? "" : "/") +
                         std::string(ent->d_name);
-                bool success = _copyFile(newSrcFile, newDstFile, callback);
-                if (!success) {
-                    if (callback != nullptr) {
-                        callback(srcFile, dstFile, -1);
-                    }
-                    closedir(dir);
-                    return false;
-                }
+                files->emplace_back(newSrcFile, newDstFile);
             } else {
-                bool success = _copy(newSrcFile.path, newDstFile.path, callback);
+                bool success = _copy(newSrcFile.path, newDstFile.path, callback, files);
                 if (!success) {
                     if (callback != nullptr) {
                         callback(srcFile, dstFile, -1);
@@ -395,6 +643,46 @@ bool POSIXIo::_copy(const std::string &src, const std::string &dst,
     return true;
 }
 
+bool POSIXIo::_copyFiles(const std::vector<std::pair<File, File>> &files,
+                         const std::function<void(File, File, float)> &callback) {
+    int threads = std::min(m_copy_threads, (int) files.size());
+    if (threads <= 1) {
+        for (const auto &file: files) {
+            if (!_copyFile(file.first, file.second, callback)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // callers don't expect concurrent callbacks
+    Mutex *mutex = new C2DMutex();
+    std::function<void(File, File, float)> serialized = nullptr;
+    if (callback != nullptr) {
+        serialized = [mutex, &callback](const File &src, const File &dst, float progress) {
+            mutex->lock();
+            callback(src, dst, progress);
+            mutex->unlock();
+        };
+    }
+
+    // many small files (roms sets) are bound by the per file latency, not by the bandwidth
+    std::atomic<bool> failed{false};
+    auto pool = new ThreadPool(threads);
+    for (const auto &file: files) {
+        pool->push([this, &file, &failed, &serialized](int) {
+            if (!failed && !_copyFile(file.first, file.second, serialized)) {
+                failed = true;
+            }
+        });
+    }
+    pool->wait();
+    delete (pool);
+    delete (mutex);
+
+    return !failed;
+}
+
 bool POSIXIo::_copyFile(const File &src, const File &dst,
                         const std::function<void(File, File, float)> &callback) {
     if (src.path == dst.path) {
@@ -414,7 +702,7 @@ bool POSIXIo::_copyFile(const File &src, const File &dst,
         return false;
     }
 
-    FILE *srcFd = fopen(src.path.c_str(), "r");
+    FILE *srcFd = fopen(src.path.c_str(), "rb");
     if (srcFd == nullptr) {
         if (callback != nullptr) {
             callback(src, dst, -1);
@@ -422,7 +710,7 @@ bool POSIXIo::_copyFile(const File &src, const File &dst,
         return false;
     }
 
-    FILE *dstFd = fopen(dst.path.c_str(), "w");
+    FILE *dstFd = fopen(dst.path.c_str(), "wb");
     if (dstFd == nullptr) {
         fclose(srcFd);
         if (callback != nullptr) {
@@ -431,43 +719,101 @@ bool POSIXIo::_copyFile(const File &src, const File &dst,
         return false;
     }
 
-    auto buf = (unsigned char *) malloc(C2D_IO_COPY_BUFFER_SIZE);
-    if (buf == nullptr) {
-        fclose(srcFd);
-        fclose(dstFd);
-        if (callback != nullptr) {
-            callback(src, dst, -1);
-        }
-        return false;
-    }
+    // the listed size may be deferred (0), or outdated
+    struct stat st{};
+    size_t size = fstat(fileno(srcFd), &st) == 0 ? (size_t) st.st_size : src.size;
+    size_t totalBytes = 0;
+    int64_t lastProgress = Utility::getTimeUs();
+    bool done = false, failed = false;
 
     if (callback != nullptr) {
         callback(src, dst, 0);
     }
 
-    size_t readBytes, writeBytes, totalBytes = 0;
-    while ((readBytes = fread(buf, 1, C2D_IO_COPY_BUFFER_SIZE, srcFd)) > 0) {
-        writeBytes = fwrite(buf, 1, readBytes, dstFd);
-        if (writeBytes < 0) {
-            free(buf);
-            fclose(srcFd);
-            fclose(dstFd);
-            if (callback != nullptr) {
-                callback(src, dst, -1);
+    // progress callbacks are throttled, a callback per chunk can cost more than the copy itself
+    auto progress = [&](size_t bytes) {
+        totalBytes += bytes;
+        if (callback != nullptr && size > 0) {
+            int64_t now = Utility::getTimeUs();
+            if (now - lastProgress >= C2D_IO_COPY_PROGRESS_INTERVAL_US) {
+                lastProgress = now;
+                callback(src, dst, std::min((float) totalBytes / (float) size, 1.0f));
+            }
+        }
+    };
+
+    // nothing was read or written through the stdio buffers yet, the descriptors
+    // offsets are the stdio ones, so the buffered copy below can resume a kernel one
+#ifdef C2D_IO_COPY_FILE_RANGE
+    while (!done && !failed) {
+        ssize_t n = copy_file_range(fileno(srcFd), nullptr, fileno(dstFd), nullptr, C2D_IO_COPY_CHUNK_SIZE, 0);
+        if (n < 0) {
+            // not supported (old kernel, cross filesystem copy on old kernels, some filesystems)
+            if (errno != ENOSYS && errno != EXDEV && errno != EINVAL && errno != EOPNOTSUPP) {
+                failed = true;
+            }
+            break;
+        }
+        if (n == 0) {
+            // some pseudo filesystems report 0 instead of an error
+            done = totalBytes > 0 || size == 0;
+            break;
+        }
+        progress((size_t) n);
+    }
+#endif
+#ifdef C2D_IO_SENDFILE
+    while (!done && !failed) {
+        ssize_t n = sendfile(fileno(dstFd), fileno(srcFd), nullptr, C2D_IO_COPY_CHUNK_SIZE);
+        if (n < 0) {
+            if (errno != ENOSYS && errno != EINVAL) {
+                failed = true;
             }
-            return false;
+            break;
+        }
+        if (n == 0) {
+            done = true;
+            break;
         }
+        progress((size_t) n);
+    }
+#endif
 
-        if (callback != nullptr) {
-            totalBytes += writeBytes;
-            float progress = (float) totalBytes / (float) src.size;
-            callback(src, dst, progress);
+    if (!done && !failed) {
+        auto buf = (unsigned char *) malloc(C2D_IO_COPY_BUFFER_SIZE);
+        if (buf == nullptr) {
+            failed = true;
+        } else {
+            size_t readBytes;
+            while ((readBytes = fread(buf, 1, C2D_IO_COPY_BUFFER_SIZE, srcFd)) > 0) {
+                if (fwrite(buf, 1, readBytes, dstFd) != readBytes) {
+                    failed = true;
+                    break;
+                }
+                progress(readBytes);
+            }
+            failed |= ferror(srcFd) != 0;
+            free(buf);
         }
     }
 
-    free(buf);
     fclose(srcFd);
-    fclose(dstFd);
+    failed |= fclose(dstFd) != 0;
+
+    if (failed) {
+        if (callback != nullptr) {
+            callback(src, dst, -1);
+        }
+        return false;
+    }
+
+    m_copy_files++;
+    m_copy_bytes += totalBytes;
+
+    // the last progress is never throttled
+    if (callback != nullptr) {
+        callback(src, dst, 1);
+    }
 
     return true;
 }
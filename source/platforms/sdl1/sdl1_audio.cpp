@@ -15,10 +15,15 @@ static void audioThread(void *data, Uint8 *stream, int size) {
     //printf("c2d::sdl1audio::thread: want: %i, filled: %i\n",
     //       size >> 1, audio->getSampleBufferQueued());
 
-    if (audio->getSampleBufferQueued() >= size >> 1) {
-        audio->lock();
-        audio->getSampleBuffer()->pull((int16_t *) stream, size >> 1);
-        audio->unlock();
+    audio->recordCallback();
+    if (audio->getSampleBuffer()->pull((int16_t *) stream, size >> 1)) {
+        audio->notify();
+    } else {
+        audio->recordUnderrun();
+    }
+
+    if (Mixer *mixer = audio->getMixer()) {
+        mixer->mix((int16_t *) stream, (size >> 1) / audio->getChannels());
     }
 }
 
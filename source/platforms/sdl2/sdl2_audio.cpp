@@ -12,13 +12,17 @@ static void audioThread(void *data, Uint8 *stream, int len) {
     int samples = len >> 1;
 
     //printf("c2d::sdl2audio::thread: want: %i (len: %i), queued: %i\n", samples, len, audio->getSampleBufferQueued());
-    if (audio->getSampleBufferQueued() >= samples) {
-        audio->lock();
-        audio->getSampleBuffer()->pull((int16_t *) stream, samples);
-        audio->unlock();
-        //printf("c2d::sdl2audio::thread: queued: %i\n", audio->getSampleBufferQueued());
+    // lock-free, never block the real-time audio thread
+    audio->recordCallback();
+    if (audio->getSampleBuffer()->pull((int16_t *) stream, samples)) {
+        audio->notify();
     } else {
         memset(stream, 0, len);
+        audio->recordUnderrun();
+    }
+
+    if (Mixer *mixer = audio->getMixer()) {
+        mixer->mix((int16_t *) stream, samples / audio->getChannels());
     }
 }
 
@@ -18,6 +18,15 @@ int SDL2Cond::wait(Mutex *mutex) {
     return SDL_CondWait(cond, ((SDL2Mutex *) mutex)->mutex);
 }
 
+int SDL2Cond::waitTimeout(Mutex *mutex, unsigned int ms) {
+    int res = SDL_CondWaitTimeout(cond, ((SDL2Mutex *) mutex)->mutex, ms);
+    return res == SDL_MUTEX_TIMEDOUT ? C2D_COND_TIMEDOUT : res;
+}
+
 int SDL2Cond::signal() {
     return SDL_CondSignal(cond);
 }
+
+int SDL2Cond::broadcast() {
+    return SDL_CondBroadcast(cond);
+}
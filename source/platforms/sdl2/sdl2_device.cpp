@@ -21,3 +21,7 @@ Vector2i SDL2Device::getDisplaySize() {
 
     return {dm.w, dm.h};
 }
+
+int SDL2Device::getCpuCount() {
+    return SDL_GetCPUCount();
+}
@@ -7,6 +7,15 @@
 using namespace c2d;
 
 SDL2Input::SDL2Input() : Input() {
+    m_mutex = new C2DMutex();
+    m_event_driven = true;
+    for (auto &id: m_ids) {
+        id = -1;
+    }
+#ifndef NO_KEYBOARD
+    m_keys.resize(SDL_NUM_SCANCODES);
+#endif
+
     if (SDL_WasInit(SDL_INIT_GAMECONTROLLER) == 0) {
         SDL_InitSubSystem(SDL_INIT_GAMECONTROLLER);
     }
@@ -34,23 +43,218 @@ SDL2Input::SDL2Input() : Input() {
             m_players[i].data = pad;
             m_players[i].id = i;
             m_players[i].enabled = true;
+            m_ids[i] = SDL_JoystickInstanceID(SDL_GameControllerGetJoystick(pad));
+            // initial state, then kept up to date from events
+            for (int a = 0; a < SDL_CONTROLLER_AXIS_MAX; a++) {
+                m_axes[i][a] = SDL_GameControllerGetAxis(pad, (SDL_GameControllerAxis) a);
+            }
         }
     } else {
         // allow keyboard mapping to player1
         m_players[0].enabled = true;
     }
+
+    // Input constructor default mappings
+    for (int i = 0; i < PLAYER_MAX; i++) {
+        buildLookup(i);
+    }
+}
+
+int SDL2Input::getSource(int value) {
+    if (value >= (int) SDL_CONTROLLER_AXIS_TRIGGERLEFT + 100 && value <= (int) SDL_CONTROLLER_AXIS_TRIGGERRIGHT + 100) {
+        return SDL_CONTROLLER_BUTTON_MAX + value - 100 - SDL_CONTROLLER_AXIS_TRIGGERLEFT;
+    }
+    if (value >= 0 && value < SDL_CONTROLLER_BUTTON_MAX) {
+        return value;
+    }
+    return -1;
+}
+
+void SDL2Input::buildLookup(int player) {
+    m_mutex->lock();
+    memset(m_source_buttons[player], 0, sizeof(m_source_buttons[player]));
+    for (const auto &buttonMap: m_players[player].mapping) {
+        int source = getSource(buttonMap.value);
+        if (source >= 0) {
+            m_source_buttons[player][source] |= buttonMap.button;
+        }
+    }
+    m_mutex->unlock();
+
+    // remapped while pressed: recompute the mapped state
+    unsigned int buttons = 0;
+    for (int i = 0; i < SourceCount; i++) {
+        if (m_sources[player] & (1u << i)) {
+            buttons |= m_source_buttons[player][i];
+        }
+    }
+    m_buttons[player] = buttons;
+}
+
+void SDL2Input::setJoystickMapping(int player, const std::vector<ButtonMapping> &mapping,
+                                   const Vector2i &leftAxis, const Vector2i &rightAxis, int dz) {
+    m_mutex->lock();
+    Input::setJoystickMapping(player, mapping, leftAxis, rightAxis, dz);
+    m_mutex->unlock();
+    if (player < PLAYER_MAX) {
+        buildLookup(player);
+    }
+}
+
+void SDL2Input::setKeyboardMapping(const std::vector<ButtonMapping> &mapping) {
+    m_mutex->lock();
+    Input::setKeyboardMapping(mapping);
+    m_mutex->unlock();
+    m_key_buttons = Input::getMappedKeys();
+}
+
+bool SDL2Input::pollSnapshot(Snapshot *snapshot) {
+    // read the devices directly, the event queue belongs to the main thread
+    SDL_GameControllerUpdate();
+
+    m_mutex->lock();
+
+    for (int i = 0; i < PLAYER_MAX; i++) {
+        const Player &player = m_players[i];
+        auto pad = (SDL_GameController *) player.data;
+        snapshot->buttons[i] = 0;
+        if (!player.enabled || !pad) {
+            memset(snapshot->axes[i], 0, sizeof(snapshot->axes[i]));
+            continue;
+        }
+
+        for (int source = 0; source < SourceCount; source++) {
+            if (!m_source_buttons[i][source]) {
+                continue;
+            }
+            bool pressed = source < SDL_CONTROLLER_BUTTON_MAX
+                           ? SDL_GameControllerGetButton(pad, (SDL_GameControllerButton) source) > 0
+                           : SDL_GameControllerGetAxis(pad, (SDL_GameControllerAxis) (
+                                   SDL_CONTROLLER_AXIS_TRIGGERLEFT + source - SDL_CONTROLLER_BUTTON_MAX)) > player.dz;
+            if (pressed) {
+                snapshot->buttons[i] |= m_source_buttons[i][source];
+            }
+        }
+
+        const Axis *axes[4] = {&player.lx, &player.ly, &player.rx, &player.ry};
+        for (int a = 0; a < 4; a++) {
+            snapshot->axes[i][a] = SDL_GameControllerGetAxis(pad, (SDL_GameControllerAxis) axes[a]->id);
+        }
+    }
+
+#ifndef NO_KEYBOARD
+    // as fresh as the last event pump
+    const Uint8 *keys = SDL_GetKeyboardState(nullptr);
+    for (const auto &keyMap: m_keyboard.mapping) {
+        if (keyMap.value >= 0 && keyMap.value < SDL_NUM_SCANCODES && keys[keyMap.value]) {
+            snapshot->buttons[0] |= keyMap.button;
+        }
+    }
+#endif
+
+    m_mutex->unlock();
+
+    return true;
+}
+
+int SDL2Input::getPlayerIndex(SDL_JoystickID id) {
+    for (int i = 0; i < PLAYER_MAX; i++) {
+        if (m_ids[i] == id && m_players[i].enabled) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void SDL2Input::setSource(int player, int source, bool pressed, int64_t time) {
+    uint32_t bit = 1u << source;
+    if (((m_sources[player] & bit) != 0) == pressed) {
+        return;
+    }
+
+    if (pressed) {
+        m_sources[player] |= bit;
+    } else {
+        m_sources[player] &= ~bit;
+    }
+
+    // several sources can be mapped to the same button, only report real transitions
+    unsigned int buttons = 0;
+    for (int i = 0; i < SourceCount; i++) {
+        if (m_sources[player] & (1u << i)) {
+            buttons |= m_source_buttons[player][i];
+        }
+    }
+    pushEvents(player, m_buttons[player], buttons, time);
+    m_buttons[player] = buttons;
+}
+
+void SDL2Input::setKey(int key, bool pressed, int64_t time) {
+    if (key < 0 || key >= (int) m_keys.size() || m_keys[key] == (uint8_t) pressed) {
+        return;
+    }
+
+    m_keys[key] = (uint8_t) pressed;
+    unsigned int buttons = Input::getMappedKeys();
+    pushEvents(0, m_key_buttons, buttons, time);
+    m_key_buttons = buttons;
+}
+
+void SDL2Input::handleEvent(const SDL_Event &event, int64_t time) {
+    int player;
+
+    switch (event.type) {
+        case SDL_CONTROLLERBUTTONDOWN:
+        case SDL_CONTROLLERBUTTONUP:
+            if ((player = getPlayerIndex(event.cbutton.which)) >= 0 && event.cbutton.button < SDL_CONTROLLER_BUTTON_MAX) {
+                setSource(player, event.cbutton.button, event.type == SDL_CONTROLLERBUTTONDOWN, time);
+            }
+            break;
+        case SDL_CONTROLLERAXISMOTION:
+            if ((player = getPlayerIndex(event.caxis.which)) >= 0 && event.caxis.axis < SDL_CONTROLLER_AXIS_MAX) {
+                m_axes[player][event.caxis.axis] = event.caxis.value;
+                if (event.caxis.axis == SDL_CONTROLLER_AXIS_TRIGGERLEFT
+                    || event.caxis.axis == SDL_CONTROLLER_AXIS_TRIGGERRIGHT) {
+                    setSource(player, getSource(event.caxis.axis + 100),
+                              event.caxis.value > m_players[player].dz, time);
+                }
+            }
+            break;
+        case SDL_CONTROLLERDEVICEREMOVED:
+            if ((player = getPlayerIndex(event.cdevice.which)) >= 0) {
+                for (int i = 0; i < SourceCount; i++) {
+                    setSource(player, i, false, time);
+                }
+                memset(m_axes[player], 0, sizeof(m_axes[player]));
+            }
+            break;
+#ifndef NO_KEYBOARD
+        case SDL_KEYDOWN:
+        case SDL_KEYUP:
+            if (!event.key.repeat) {
+                setKey(event.key.keysym.scancode, event.type == SDL_KEYDOWN, time);
+            }
+            break;
+#endif
+        default:
+            break;
+    }
 }
 
 Input::Player *SDL2Input::update() {
     bool quit = false;
 
-    // be sure sdl events are "pumped/cleared" before calling Input::update
+    // consume every sdl event, sdl timestamps are milliseconds ticks: convert them to our clock
+    clearEvents();
+    int64_t now = getTime();
+    Uint32 ticks = SDL_GetTicks();
     SDL_Event event = {};
     while (SDL_PollEvent(&event)) {
         if (event.type == SDL_QUIT) {
             quit = true;
-            break;
+            continue;
         }
+        handleEvent(event, now - (int64_t) (ticks - event.common.timestamp) * 1000);
     }
 
     Player *players = Input::update();
@@ -62,33 +266,42 @@ Input::Player *SDL2Input::update() {
 }
 
 Vector2f SDL2Input::getAxisState(const Player &player, int xAxis, int yAxis) {
-    auto pad = (SDL_GameController *) player.data;
+    int index = (int) (&player - m_players);
+    if (xAxis < 0 || xAxis >= SDL_CONTROLLER_AXIS_MAX || yAxis < 0 || yAxis >= SDL_CONTROLLER_AXIS_MAX) {
+        return {};
+    }
 
-    return {
-            (float) SDL_GameControllerGetAxis(pad, (SDL_GameControllerAxis) xAxis),
-            (float) SDL_GameControllerGetAxis(pad, (SDL_GameControllerAxis) yAxis)
-    };
+    return {(float) m_axes[index][xAxis], (float) m_axes[index][yAxis]};
 }
 
 int SDL2Input::getButtonState(const Player &player, int button) {
-    auto pad = (SDL_GameController *) player.data;
-
-    if (button == ((int) SDL_CONTROLLER_AXIS_TRIGGERLEFT + 100)
-        || button == ((int) SDL_CONTROLLER_AXIS_TRIGGERRIGHT + 100)) {
-        return SDL_GameControllerGetAxis(pad, (SDL_GameControllerAxis) (button - 100)) > player.dz;
+    int source = getSource(button);
+    if (source < 0) {
+        return 0;
     }
 
-    return SDL_GameControllerGetButton(pad, (SDL_GameControllerButton) button) > 0;
+    return (m_sources[&player - m_players] & (1u << source)) != 0;
 }
 
 int SDL2Input::getKeyState(int key) {
 #ifndef NO_KEYBOARD
-    return SDL_GetKeyboardState(nullptr)[key] > 0;
+    return key >= 0 && key < (int) m_keys.size() && m_keys[key] > 0;
 #else
     return 0;
 #endif
 }
 
+unsigned int SDL2Input::getMappedButtons(const Player &player) {
+    int index = (int) (&player - m_players);
+
+    // include buttons pressed and released since the last update
+    return m_buttons[index] | m_pressed[index];
+}
+
+unsigned int SDL2Input::getMappedKeys() {
+    return m_key_buttons | m_pressed[0];
+}
+
 Vector2f SDL2Input::getTouch() {
     int x, y;
 
@@ -103,6 +316,8 @@ int SDL2Input::waitButton(int player) {
     SDL_Event event = {};
 
     while (SDL_PollEvent(&event) != 0) {
+        // keep the state in sync with the events we consume here
+        handleEvent(event, getTime());
         if (event.type == SDL_CONTROLLERBUTTONDOWN) {
             return event.cbutton.button;
         } else if (event.type == SDL_CONTROLLERAXISMOTION) {
@@ -120,6 +335,9 @@ int SDL2Input::waitButton(int player) {
 }
 
 SDL2Input::~SDL2Input() {
+    SDL2Input::stopPolling();
+    delete (m_mutex);
+
     if (SDL_WasInit(SDL_INIT_GAMECONTROLLER)) {
         SDL_QuitSubSystem(SDL_INIT_GAMECONTROLLER);
     }
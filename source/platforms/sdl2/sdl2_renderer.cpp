@@ -136,6 +136,7 @@ void SDL2Renderer::flip(bool draw, bool inputs) {
 
     // flip
     SDL_GL_SwapWindow(window);
+    onPresented();
 }
 
 void SDL2Renderer::delay(unsigned int ms) {
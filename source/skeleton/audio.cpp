@@ -3,12 +3,103 @@
 //
 
 #include <string>
+#include <cmath>
 #include "cross2d/c2d.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 using namespace c2d;
 
+// input to S16 stereo conversion kernels, the "count" samples are interleaved
+
+static inline int16_t floatToS16(float v) {
+    v *= 32767.0f;
+    return (int16_t) (v > 32767.0f ? 32767 : (v < -32768.0f ? -32768 : (int) v));
+}
+
+static void s16MonoToStereo(const int16_t *src, int16_t *dst, int frames) {
+    int i = 0;
+#if defined(__SSE2__)
+    for (; i + 8 <= frames; i += 8) {
+        __m128i s = _mm_loadu_si128((const __m128i *) (src + i));
+        _mm_storeu_si128((__m128i *) (dst + i * 2), _mm_unpacklo_epi16(s, s));
+        _mm_storeu_si128((__m128i *) (dst + i * 2 + 8), _mm_unpackhi_epi16(s, s));
+    }
+#elif defined(__ARM_NEON)
+    for (; i + 8 <= frames; i += 8) {
+        int16x8_t s = vld1q_s16(src + i);
+        vst2q_s16(dst + i * 2, (int16x8x2_t) {{s, s}});
+    }
+#endif
+    for (; i < frames; i++) {
+        dst[i * 2] = dst[i * 2 + 1] = src[i];
+    }
+}
+
+static void s32ToS16(const int32_t *src, int16_t *dst, int count) {
+    int i = 0;
+#if defined(__SSE2__)
+    for (; i + 8 <= count; i += 8) {
+        __m128i lo = _mm_srai_epi32(_mm_loadu_si128((const __m128i *) (src + i)), 16);
+        __m128i hi = _mm_srai_epi32(_mm_loadu_si128((const __m128i *) (src + i + 4)), 16);
+        _mm_storeu_si128((__m128i *) (dst + i), _mm_packs_epi32(lo, hi));
+    }
+#elif defined(__ARM_NEON)
+    for (; i + 8 <= count; i += 8) {
+        int16x4_t lo = vshrn_n_s32(vld1q_s32(src + i), 16);
+        int16x4_t hi = vshrn_n_s32(vld1q_s32(src + i + 4), 16);
+        vst1q_s16(dst + i, vcombine_s16(lo, hi));
+    }
+#endif
+    for (; i < count; i++) {
+        dst[i] = (int16_t) (src[i] >> 16);
+    }
+}
+
+static void f32ToS16(const float *src, int16_t *dst, int count) {
+    int i = 0;
+#if defined(__SSE2__)
+    // clamp first, out of range conversions would give INT_MIN
+    __m128 scale = _mm_set1_ps(32767.0f), lim = _mm_set1_ps(1.0f), nlim = _mm_set1_ps(-1.0f);
+    for (; i + 8 <= count; i += 8) {
+        __m128 l = _mm_max_ps(_mm_min_ps(_mm_loadu_ps(src + i), lim), nlim);
+        __m128 h = _mm_max_ps(_mm_min_ps(_mm_loadu_ps(src + i + 4), lim), nlim);
+        __m128i lo = _mm_cvtps_epi32(_mm_mul_ps(l, scale));
+        __m128i hi = _mm_cvtps_epi32(_mm_mul_ps(h, scale));
+        _mm_storeu_si128((__m128i *) (dst + i), _mm_packs_epi32(lo, hi));
+    }
+#elif defined(__ARM_NEON)
+    for (; i + 8 <= count; i += 8) {
+        int32x4_t lo = vcvtq_s32_f32(vmulq_n_f32(vld1q_f32(src + i), 32767.0f));
+        int32x4_t hi = vcvtq_s32_f32(vmulq_n_f32(vld1q_f32(src + i + 4), 32767.0f));
+        vst1q_s16(dst + i, vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi)));
+    }
+#endif
+    for (; i < count; i++) {
+        dst[i] = floatToS16(src[i]);
+    }
+}
+
+static inline float sampleToFloat(const void *src, Audio::Format format, int index) {
+    switch (format) {
+        case Audio::S32:
+            return (float) ((const int32_t *) src)[index] * (1.0f / 2147483648.0f);
+        case Audio::F32:
+            return ((const float *) src)[index];
+        default:
+            return (float) ((const int16_t *) src)[index] * (1.0f / 32768.0f);
+    }
+}
+
 Audio::Audio(int rate, int samples, C2DAudioCallback cb) {
     mutex = new C2DMutex();
+#ifdef C2DCond
+    cond = new C2DCond();
+#endif
 
     m_sample_rate = rate;
     m_samples = samples;
@@ -34,53 +125,288 @@ void Audio::play(const void *data, int samples, SyncMode syncMode) {
             return;
         }
 
-        if (syncMode == LowLatency) {
-            lock();
-            int queued = getSampleBufferQueued();
-            unlock();
-            while (queued >= getSamplesSize()) {
-                if (!available) return;
-                if (c2d_renderer) c2d_renderer->delayUs(1);
-                lock();
-                queued = getSampleBufferQueued();
-                unlock();
+        // convert in place, in the ring buffer, unless we need a device format copy to resample
+        bool native = m_input_format == S16 && m_input_channels == channels;
+        bool resampling = syncMode == DynamicRate || (m_input_rate > 0 && m_input_rate != m_sample_rate);
+        if (!native && resampling) {
+            if (m_convert_buffer.size() < (size_t) (samples * channels)) {
+                m_convert_buffer.resize((size_t) (samples * channels));
             }
+            convert(data, m_convert_buffer.data(), samples);
+            data = m_convert_buffer.data();
+        }
+
+        // the sample buffer is lock-free (single producer: us, single consumer: the audio callback)
+        if (syncMode == DynamicRate) {
+            // standard dynamic rate control: "direction" goes from 1 (buffer empty) to -1 (buffer full),
+            // so we produce slightly more samples when the buffer drains and slightly less when it fills up
+            int capacity = getSampleBufferCapacity();
+            int half = capacity / 2;
+            double direction = (double) (getSampleBufferAvailable() - half) / (double) half;
+            m_drc_ratio = 1.0 + m_drc_delta * direction;
+
+            int count = resample((const int16_t *) data, samples, m_drc_ratio);
+            // never block, drop what doesn't fit (can only happen if the producer runs way too fast)
+            int space = getSampleBufferAvailable();
+            if (count > space) {
+                count = space - space % channels;
+                m_stats_overruns++;
+            }
+            m_buffer->push(m_resample_buffer.data(), count);
+            return;
+        }
+
+        if (resampling) {
+            // input rate conversion, then queued as device format data
+            samples = resample((const int16_t *) data, samples, 1.0) / channels;
+            data = m_resample_buffer.data();
+            native = true;
+        }
+
+        if (syncMode == LowLatency) {
+            if (!waitQueued(getSamplesSize() - 1)) return;
         } else if (syncMode == Safe) {
             //printf("play: samples: %i, queued: %i, available: %i\n",
             //     samples * channels, getSampleBufferQueued(), getSampleBufferAvailable());
-            lock();
-            int space = getSampleBufferAvailable();
-            unlock();
-            while (space < samples * channels) {
-                //printf("play (delay): samples: %i, queued: %i\n", getSamples() * channels, getSampleBufferQueued());
-                if (!available) return;
-                if (c2d_renderer) c2d_renderer->delayUs(1);
-                lock();
-                space = getSampleBufferAvailable();
-                unlock();
-            }
+            if (!waitQueued(getSampleBufferCapacity() - samples * channels)) return;
             //printf("play (done): queued: %i\n", getSampleBufferQueued());
         }
 
-        lock();
-        m_buffer->push((int16_t *) data, samples * channels);
-        unlock();
+        if (native) {
+            if (!m_buffer->push((int16_t *) data, samples * channels)) {
+                m_stats_overruns++;
+            }
+            return;
+        }
+
+        int16_t *first, *second;
+        int firstSize;
+        if (!m_buffer->reserve(samples * channels, &first, &firstSize, &second)) {
+            m_stats_overruns++;
+            return;
+        }
+
+        int firstFrames = firstSize / channels;
+        convert(data, first, firstFrames);
+        if (samples > firstFrames) {
+            int bytes = m_input_format == S16 ? 2 : 4;
+            convert((const uint8_t *) data + firstFrames * m_input_channels * bytes, second, samples - firstFrames);
+        }
+        m_buffer->push(nullptr, samples * channels);
+    }
+}
+
+void Audio::setInputFormat(Format format, int inputChannels) {
+    if (inputChannels < 1 || inputChannels > 8 || channels != 2) {
+        printf("Audio::setInputFormat: unsupported channels count (%i)\n", inputChannels);
+        return;
+    }
+
+    m_input_format = format;
+    m_input_channels = inputChannels;
+
+    // downmix matrix (used for more than 2 channels), wav/smpte channels order. Center and
+    // rear/side channels are attenuated by 3dB, lfe is dropped, then everything is normalized
+    // so that full scale input on every channel doesn't clip
+    const float c = 0.7071f;
+    static const float layouts[9][8][2] = {
+            {},
+            {},
+            {},
+            {{1, 0}, {0, 1}, {c, c}},
+            {{1, 0}, {0, 1}, {c, 0}, {0, c}},
+            {{1, 0}, {0, 1}, {c, c}, {c, 0}, {0, c}},
+            {{1, 0}, {0, 1}, {c, c}, {0, 0}, {c, 0}, {0, c}},
+            {{1, 0}, {0, 1}, {c, c}, {0, 0}, {c * c, c * c}, {c, 0}, {0, c}},
+            {{1, 0}, {0, 1}, {c, c}, {0, 0}, {c, 0}, {0, c}, {c, 0}, {0, c}},
+    };
+    float sum = 0;
+    for (int i = 0; i < inputChannels; i++) {
+        sum += layouts[inputChannels][i][0];
+    }
+    for (int i = 0; i < 8; i++) {
+        m_downmix[0][i] = i < inputChannels && sum > 0 ? layouts[inputChannels][i][0] / sum : 0;
+        m_downmix[1][i] = i < inputChannels && sum > 0 ? layouts[inputChannels][i][1] / sum : 0;
+    }
+}
+
+Audio::Format Audio::getInputFormat() {
+    return m_input_format;
+}
+
+int Audio::getInputChannels() {
+    return m_input_channels;
+}
+
+void Audio::convert(const void *src, int16_t *dst, int frames) {
+    if (frames <= 0) {
+        return;
+    }
+
+    if (m_input_channels <= 2) {
+        // mono and stereo have vectorized paths, mono is converted then duplicated in place
+        int count = frames * m_input_channels;
+        int16_t *out = m_input_channels == 1 ? dst + frames : dst;
+        switch (m_input_format) {
+            case S32:
+                s32ToS16((const int32_t *) src, out, count);
+                break;
+            case F32:
+                f32ToS16((const float *) src, out, count);
+                break;
+            default:
+                if (out != src) memcpy(out, src, count * sizeof(int16_t));
+                break;
+        }
+        if (m_input_channels == 1) {
+            // the mono samples were written in the second half, expanding them forward is safe
+            s16MonoToStereo(out, dst, frames);
+        }
+        return;
+    }
+
+    // multichannel downmix
+    for (int i = 0; i < frames; i++) {
+        float left = 0, right = 0;
+        for (int ch = 0; ch < m_input_channels; ch++) {
+            float v = sampleToFloat(src, m_input_format, i * m_input_channels + ch);
+            left += v * m_downmix[0][ch];
+            right += v * m_downmix[1][ch];
+        }
+        dst[i * 2] = floatToS16(left);
+        dst[i * 2 + 1] = floatToS16(right);
+    }
+}
+
+bool Audio::waitQueued(int maxQueued) {
+    while (getSampleBufferQueued() > maxQueued) {
+        if (!available) return false;
+        if (cond) {
+            // the backend signals us each time it pulls samples. It doesn't take the mutex (it must
+            // not block), so a wakeup can be missed between our check and the wait: the timeout
+            // (half an audio buffer) bounds that case
+            int timeout = m_samples * 500 / m_sample_rate;
+            mutex->lock();
+            waiting.store(true);
+            if (getSampleBufferQueued() > maxQueued) {
+                cond->waitTimeout(mutex, timeout > 1 ? timeout : 1);
+            }
+            waiting.store(false);
+            mutex->unlock();
+        } else if (c2d_renderer) {
+            c2d_renderer->delayUs(1);
+        }
+    }
+
+    return true;
+}
+
+void Audio::setMixer(Mixer *mixer) {
+    m_mixer.store(mixer);
+}
+
+Mixer *Audio::getMixer() {
+    return m_mixer.load();
+}
+
+void Audio::recordCallback() {
+    int64_t now = Utility::getTimeUs();
+    int queued = getSampleBufferQueued();
+
+    // resets are requested from other threads, but done here so the audio thread owns its state
+    bool first = m_stats_callbacks.load(std::memory_order_relaxed) == 0;
+    if (m_stats_reset.exchange(false)) {
+        m_stats_callbacks = 0;
+        m_stats_underruns = 0;
+        m_stats_overruns = 0;
+        m_stats_interval = 0;
+        m_stats_jitter = 0;
+        for (auto &bucket: m_stats_histogram) bucket = 0;
+        first = true;
+    }
+
+    if (first) {
+        m_stats_queued_min = queued;
+        m_stats_queued_max = queued;
+    } else {
+        // smoothed interval, and jitter as the smoothed deviation from it (rfc 3550: j += (|d| - j) / 16)
+        auto interval = (float) (now - m_stats_last_us);
+        float avg = m_stats_interval.load(std::memory_order_relaxed);
+        avg = avg == 0 ? interval : avg + (interval - avg) / 16.0f;
+        float jitter = m_stats_jitter.load(std::memory_order_relaxed);
+        jitter += (std::fabs(interval - avg) - jitter) / 16.0f;
+        m_stats_interval.store(avg, std::memory_order_relaxed);
+        m_stats_jitter.store(jitter, std::memory_order_relaxed);
+        if (queued < m_stats_queued_min.load(std::memory_order_relaxed)) m_stats_queued_min = queued;
+        if (queued > m_stats_queued_max.load(std::memory_order_relaxed)) m_stats_queued_max = queued;
+    }
+
+    m_stats_last_us = now;
+    m_stats_queued.store(queued, std::memory_order_relaxed);
+    unsigned int callbacks = m_stats_callbacks.fetch_add(1, std::memory_order_relaxed) + 1;
+
+    if (m_stats_histogram_enabled.load(std::memory_order_relaxed)) {
+        int capacity = getSampleBufferCapacity();
+        int bucket = capacity > 0 ? queued * StatsHistogramSize / capacity : 0;
+        if (bucket >= StatsHistogramSize) bucket = StatsHistogramSize - 1;
+        m_stats_histogram[bucket].fetch_add(1, std::memory_order_relaxed);
+        if ((callbacks & 1023) == 0) {
+            for (auto &b: m_stats_histogram) {
+                b.store(b.load(std::memory_order_relaxed) / 2, std::memory_order_relaxed);
+            }
+        }
+    }
+}
+
+void Audio::recordUnderrun() {
+    m_stats_underruns.fetch_add(1, std::memory_order_relaxed);
+}
+
+Audio::Stats Audio::getStats() {
+    Stats stats;
+    stats.callbacks = m_stats_callbacks.load();
+    stats.underruns = m_stats_underruns.load();
+    stats.overruns = m_stats_overruns.load();
+    stats.queued = m_stats_queued.load();
+    stats.queuedMin = m_stats_queued_min.load();
+    stats.queuedMax = m_stats_queued_max.load();
+    stats.intervalUs = m_stats_interval.load();
+    stats.jitterUs = m_stats_jitter.load();
+    stats.latencyMs = (float) (stats.queued / channels + m_samples) * 1000.0f / (float) m_sample_rate;
+    for (int i = 0; i < StatsHistogramSize; i++) {
+        stats.histogram[i] = m_stats_histogram[i].load();
+    }
+
+    return stats;
+}
+
+void Audio::resetStats() {
+    m_stats_reset = true;
+}
+
+void Audio::setStatsHistogram(bool enable) {
+    m_stats_histogram_enabled = enable;
+}
+
+void Audio::notify() {
+    if (cond && waiting.load()) {
+        cond->signal();
     }
 }
 
 void Audio::reset() {
-    lock();
     m_buffer->clear();
-    unlock();
+    m_drc_ratio = 1.0;
+    if (m_resampler) {
+        m_resampler->reset();
+    }
     paused = false;
 }
 
 void Audio::pause(int pause) {
     paused = pause;
     if (paused) {
-        lock();
         m_buffer->clear();
-        unlock();
     }
 }
 
@@ -116,6 +442,77 @@ int Audio::getSampleBufferAvailable() {
     return m_buffer->space_empty();
 }
 
+int Audio::resample(const int16_t *src, int frames, double adjust) {
+    if (frames <= 0) {
+        return 0;
+    }
+
+    int rate = m_input_rate > 0 ? m_input_rate : m_sample_rate;
+    if (!m_resampler) {
+        m_resampler = new Resampler(rate, m_sample_rate, channels, m_resampler_quality);
+    } else {
+        m_resampler->setRates(rate, m_sample_rate);
+        m_resampler->setQuality(m_resampler_quality);
+    }
+
+    // make room for the worst case, only reallocates when the input size grows
+    auto needed = (size_t) m_resampler->getMaxOutputFrames(frames, adjust) * channels;
+    if (m_resample_buffer.size() < needed) {
+        m_resample_buffer.resize(needed);
+    }
+
+    return m_resampler->process(src, frames, m_resample_buffer.data(), adjust) * channels;
+}
+
+void Audio::setInputRate(int rate) {
+    m_input_rate = rate;
+}
+
+int Audio::getInputRate() {
+    return m_input_rate > 0 ? m_input_rate : m_sample_rate;
+}
+
+void Audio::setResamplerQuality(Resampler::Quality quality) {
+    m_resampler_quality = quality;
+}
+
+Resampler::Quality Audio::getResamplerQuality() {
+    return m_resampler_quality;
+}
+
+Resampler *Audio::getResampler() {
+    return m_resampler;
+}
+
+void Audio::setDynamicRateDelta(float delta) {
+    m_drc_delta = delta;
+}
+
+float Audio::getDynamicRateDelta() {
+    return m_drc_delta;
+}
+
+double Audio::getDynamicRateRatio() {
+    return m_drc_ratio;
+}
+
+Audio *Audio::create(int rate, int samples, C2DAudioCallback cb) {
+    const char *driver = getenv("C2D_AUDIO_DRIVER");
+    if (driver && strcmp(driver, "null") == 0) {
+        return new NullAudio(rate, samples, cb);
+    }
+    if (driver && strcmp(driver, "file") == 0) {
+        const char *path = getenv("C2D_AUDIO_FILE");
+        return new FileAudio(path ? path : "c2d_audio.wav", rate, samples, cb);
+    }
+
+#ifdef C2DAudio
+    return new C2DAudio(rate, samples, cb);
+#else
+    return new NullAudio(rate, samples, cb);
+#endif
+}
+
 int Audio::toSamples(int rate, float fps) {
     return (int) ((float) rate / fps);
 }
@@ -139,6 +536,14 @@ Audio::~Audio() {
         delete (m_buffer);
     }
 
+    if (m_resampler) {
+        delete (m_resampler);
+    }
+
+    if (cond) {
+        delete (cond);
+    }
+
     if (mutex) {
         delete (mutex);
     }
@@ -0,0 +1,183 @@
+//
+// Created by cpasjuste on 17/10/2026.
+//
+
+#include "cross2d/c2d.h"
+
+using namespace c2d;
+
+NullAudio::NullAudio(int rate, int samples, C2DAudioCallback cb) : NullAudio(rate, samples, cb, true) {}
+
+NullAudio::NullAudio(int rate, int samples, C2DAudioCallback cb, bool start) : Audio(rate, samples, cb) {
+    if (!available) {
+        return;
+    }
+
+    // same buffering as the sdl2 backend
+    m_buffer->resize(m_samples * channels * 5);
+    m_period.resize((size_t) m_samples * channels);
+
+    if (start) {
+        NullAudio::start();
+    }
+}
+
+void NullAudio::start() {
+#ifdef C2DThread
+    if (!c2d_renderer) {
+        // the consumer thread sleeps with the platform delay
+        printf("NullAudio: no renderer\n");
+        available = false;
+        return;
+    }
+    m_thread = new C2DThread(consumerThread, this);
+    printf("NullAudio: rate = %i, samples = %i, samples size = %i\n", m_sample_rate, m_samples, m_samples_size);
+#else
+    printf("NullAudio: threads are not supported on this platform\n");
+    available = false;
+#endif
+}
+
+int NullAudio::consumerThread(void *data) {
+#ifdef C2DThread
+    auto audio = (NullAudio *) data;
+    // the virtual device clock: "wait" is the time left before the next period deadline,
+    // lateness is carried over so the period doesn't drift
+    C2DClock clock;
+    long period = (long) ((long long) audio->m_samples * 1000000 / audio->m_sample_rate);
+    long wait = period;
+    bool was_paused = false;
+
+    while (!audio->m_quit.load()) {
+        wait -= clock.restart().asMicroseconds();
+        while (wait > 0 && !audio->m_quit.load()) {
+            c2d_renderer->delayUs((unsigned int) wait);
+            wait -= clock.restart().asMicroseconds();
+        }
+
+        if (audio->isPaused()) {
+            was_paused = true;
+            wait = period;
+            continue;
+        }
+        if (was_paused) {
+            was_paused = false;
+            wait = 0;
+        }
+        wait += period;
+
+        auto *stream = audio->m_period.data();
+        int count = (int) audio->m_period.size();
+        if (audio->callback) {
+            audio->callback(audio, (unsigned char *) stream, count * (int) sizeof(int16_t));
+        } else {
+            audio->recordCallback();
+            if (audio->m_buffer->pull(stream, count)) {
+                audio->notify();
+            } else {
+                memset(stream, 0, count * sizeof(int16_t));
+                audio->recordUnderrun();
+            }
+        }
+
+        if (Mixer *mixer = audio->getMixer()) {
+            mixer->mix(stream, audio->m_samples);
+        }
+
+        audio->onPeriod(stream, audio->m_samples);
+        audio->m_frames_played += audio->m_samples;
+    }
+#else
+    (void) data;
+#endif
+
+    return 0;
+}
+
+long NullAudio::getFramesPlayed() {
+    return m_frames_played.load();
+}
+
+int NullAudio::getUnderruns() {
+    return (int) getStats().underruns;
+}
+
+void NullAudio::stop() {
+    if (m_thread) {
+        m_quit = true;
+        m_thread->join();
+        delete (m_thread);
+        m_thread = nullptr;
+    }
+}
+
+NullAudio::~NullAudio() {
+    NullAudio::stop();
+}
+
+FileAudio::FileAudio(const std::string &path, int rate, int samples, C2DAudioCallback cb)
+        : NullAudio(rate, samples, cb, false) {
+    if (!available) {
+        return;
+    }
+
+    m_file = fopen(path.c_str(), "wb");
+    if (!m_file) {
+        printf("FileAudio: could not open %s for writing\n", path.c_str());
+        available = false;
+        return;
+    }
+
+    // the header is patched with the final size on close
+    writeHeader();
+    printf("FileAudio: writing to %s\n", path.c_str());
+
+    start();
+}
+
+void FileAudio::writeHeader() {
+    auto put32 = [this](uint32_t v) {
+        uint8_t b[4] = {(uint8_t) v, (uint8_t) (v >> 8), (uint8_t) (v >> 16), (uint8_t) (v >> 24)};
+        fwrite(b, 1, 4, m_file);
+    };
+    auto put16 = [this](uint16_t v) {
+        uint8_t b[2] = {(uint8_t) v, (uint8_t) (v >> 8)};
+        fwrite(b, 1, 2, m_file);
+    };
+
+    fseek(m_file, 0, SEEK_SET);
+    fwrite("RIFF", 1, 4, m_file);
+    put32(36 + m_data_size);
+    fwrite("WAVEfmt ", 1, 8, m_file);
+    put32(16);
+    put16(1); // PCM
+    put16((uint16_t) channels);
+    put32((uint32_t) m_sample_rate);
+    put32((uint32_t) (m_sample_rate * channels * 2));
+    put16((uint16_t) (channels * 2));
+    put16(16);
+    fwrite("data", 1, 4, m_file);
+    put32(m_data_size);
+}
+
+void FileAudio::onPeriod(const int16_t *samples, int frames) {
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    for (int i = 0; i < frames * channels; i++) {
+        uint8_t b[2] = {(uint8_t) samples[i], (uint8_t) (samples[i] >> 8)};
+        fwrite(b, 1, 2, m_file);
+    }
+#else
+    fwrite(samples, sizeof(int16_t), (size_t) frames * channels, m_file);
+#endif
+    m_data_size += (uint32_t) (frames * channels * sizeof(int16_t));
+}
+
+FileAudio::~FileAudio() {
+    // no more writes once the consumer is stopped
+    stop();
+
+    if (m_file) {
+        writeHeader();
+        fclose(m_file);
+    }
+}
@@ -19,11 +19,31 @@ Config::Config(const std::string &name, const std::string &path, int version) :
 bool Config::load(const std::string &overridePath) {
     std::string p = overridePath.empty() ? m_path : overridePath;
     printf("Config::load: %s\n", p.c_str());
-    if (config_read_file(&m_config, p.c_str()) == CONFIG_FALSE) {
+
+    if (!c2d_renderer) {
+        if (config_read_file(&m_config, p.c_str()) == CONFIG_FALSE) {
+            printf("Config::load: file not found: %s\n", p.c_str());
+            return false;
+        }
+        return Group::load(config_root_setting(&m_config));
+    }
+
+    // read through the io, so configs in packed/virtual filesystems can be loaded
+    Io::Map *map = c2d_renderer->getIo()->map(p);
+    if (!map) {
         printf("Config::load: file not found: %s\n", p.c_str());
         return false;
     }
 
+    // libconfig parses nul terminated strings only
+    std::string str((const char *) map->getData(), map->getSize());
+    delete (map);
+    if (config_read_string(&m_config, str.c_str()) == CONFIG_FALSE) {
+        printf("Config::load: could not parse %s (line %i: %s)\n",
+               p.c_str(), config_error_line(&m_config), config_error_text(&m_config));
+        return false;
+    }
+
     return Group::load(config_root_setting(&m_config));
 }
 
@@ -67,6 +67,10 @@ Input::Input() {
 }
 
 Input::Player *Input::update() {
+    if (!m_event_driven) {
+        clearEvents();
+    }
+
     for (auto &player: m_players) {
         if (!player.enabled) {
             continue;
@@ -140,22 +144,14 @@ Input::Player *Input::update() {
         }
 
         /// process buttons
-        for (const auto &buttonMap: player.mapping) {
-            if (getButtonState(player, buttonMap.value)) {
-                player.buttons |= buttonMap.button;
-            }
-        }
+        player.buttons |= getMappedButtons(player);
 
         /// apply rotation if needed
         applyRotation(&player);
     }
 
     /// process keyboard
-    for (const auto &keyMap: m_keyboard.mapping) {
-        if (getKeyState(keyMap.value)) {
-            m_players[0].buttons |= keyMap.button;
-        }
-    }
+    m_players[0].buttons |= getMappedKeys();
 
     /// process touch
     m_players[0].touch = getTouch();
@@ -163,6 +159,15 @@ Input::Player *Input::update() {
         m_players[0].buttons |= Input::Button::Touch;
     }
 
+    /// polled transitions
+    if (!m_event_driven) {
+        int64_t time = getTime();
+        for (int i = 0; i < PLAYER_MAX; i++) {
+            pushEvents(i, m_previous[i], m_players[i].buttons, time);
+            m_previous[i] = m_players[i].buttons;
+        }
+    }
+
     /// process auto repeat
     if (!m_repeat || m_players[0].buttons & Input::Button::Quit) {
         m_stateOld = m_players[0].buttons;
@@ -186,6 +191,183 @@ Input::Player *Input::update() {
     return m_players;
 }
 
+unsigned int Input::getMappedButtons(const Player &player) {
+    unsigned int buttons = 0;
+
+    for (const auto &buttonMap: player.mapping) {
+        if (getButtonState(player, buttonMap.value)) {
+            buttons |= buttonMap.button;
+        }
+    }
+
+    return buttons;
+}
+
+unsigned int Input::getMappedKeys() {
+    unsigned int buttons = 0;
+
+    for (const auto &keyMap: m_keyboard.mapping) {
+        if (getKeyState(keyMap.value)) {
+            buttons |= keyMap.button;
+        }
+    }
+
+    return buttons;
+}
+
+void Input::clearEvents() {
+    m_events.clear();
+    memset(m_pressed, 0, sizeof(m_pressed));
+    memset(m_released, 0, sizeof(m_released));
+}
+
+void Input::pushEvents(int player, unsigned int oldButtons, unsigned int newButtons, int64_t time) {
+    unsigned int diff = oldButtons ^ newButtons;
+
+    while (diff) {
+        unsigned int button = diff & (~diff + 1);
+        bool pressed = (newButtons & button) != 0;
+        m_events.push_back({time, player, button, pressed});
+        if (pressed) {
+            m_pressed[player] |= button;
+        } else {
+            m_released[player] |= button;
+        }
+        diff &= diff - 1;
+    }
+}
+
+const std::vector<Input::Event> &Input::getEvents() {
+    return m_events;
+}
+
+unsigned int Input::getPressed(int player) {
+    if (player < PLAYER_MAX) {
+        return m_pressed[player];
+    }
+    return 0;
+}
+
+unsigned int Input::getReleased(int player) {
+    if (player < PLAYER_MAX) {
+        return m_released[player];
+    }
+    return 0;
+}
+
+int64_t Input::getTime() {
+    return Utility::getTimeUs();
+}
+
+Input *Input::create() {
+    const char *replay = getenv("C2D_INPUT_REPLAY");
+    if (replay) {
+        return new InputReplay(replay);
+    }
+
+    const char *record = getenv("C2D_INPUT_RECORD");
+    if (record) {
+        return new InputRecorder(new C2DInput(), record);
+    }
+
+    return new C2DInput();
+}
+
+// set in m_snapshot_middle when the middle slot holds a sample the reader didn't get yet
+#define SNAPSHOT_NEW 4
+
+bool Input::startPolling(int hz) {
+    if (m_poll_thread) {
+        return true;
+    }
+
+    Snapshot test;
+    if (!pollSnapshot(&test)) {
+        printf("Input::startPolling: not supported by this input backend\n");
+        return false;
+    }
+
+#ifdef C2DThread
+    if (!c2d_renderer) {
+        // the polling thread sleeps with the platform delay
+        printf("Input::startPolling: no renderer\n");
+        return false;
+    }
+    m_poll_hz = hz > 0 ? hz : 1000;
+    m_poll_quit = false;
+    m_poll_thread = new C2DThread(pollingThread, this);
+    printf("Input::startPolling: sampling at %i hz\n", m_poll_hz);
+    return true;
+#else
+    printf("Input::startPolling: threads are not supported on this platform\n");
+    return false;
+#endif
+}
+
+void Input::stopPolling() {
+    if (m_poll_thread) {
+        m_poll_quit = true;
+        m_poll_thread->join();
+        delete (m_poll_thread);
+        m_poll_thread = nullptr;
+    }
+}
+
+bool Input::isPolling() {
+    return m_poll_thread != nullptr;
+}
+
+int Input::pollingThread(void *data) {
+#ifdef C2DThread
+    auto input = (Input *) data;
+    int64_t period = 1000000 / input->m_poll_hz;
+    int64_t deadline = getTime();
+
+    while (!input->m_poll_quit.load()) {
+        Snapshot *snapshot = &input->m_snapshots[input->m_snapshot_write];
+        if (input->pollSnapshot(snapshot)) {
+            snapshot->time = getTime();
+            snapshot->sequence = ++input->m_snapshot_sequence;
+            // publish: our slot becomes the middle one, we get the previous middle one
+            int middle = input->m_snapshot_middle.exchange(input->m_snapshot_write | SNAPSHOT_NEW,
+                                                           std::memory_order_acq_rel);
+            input->m_snapshot_write = middle & 3;
+        }
+
+        // absolute deadlines, don't accumulate drift, but don't try to catch up after a stall
+        deadline += period;
+        int64_t now = getTime();
+        if (deadline < now) {
+            deadline = now;
+        } else if (deadline > now) {
+            c2d_renderer->delayUs((unsigned int) (deadline - now));
+        }
+    }
+#else
+    (void) data;
+#endif
+
+    return 0;
+}
+
+Input::Snapshot Input::getSnapshot() {
+    if (!m_poll_thread) {
+        Snapshot snapshot;
+        if (pollSnapshot(&snapshot)) {
+            snapshot.time = getTime();
+            snapshot.sequence = ++m_snapshot_sequence;
+        }
+        return snapshot;
+    }
+
+    if (m_snapshot_middle.load(std::memory_order_acquire) & SNAPSHOT_NEW) {
+        int middle = m_snapshot_middle.exchange(m_snapshot_read, std::memory_order_acq_rel);
+        m_snapshot_read = middle & 3;
+    }
+
+    return m_snapshots[m_snapshot_read];
+}
+
 void Input::setRepeatDelay(int ms) {
     m_repeatDelay = ms;
     m_repeat = ms > 0;
@@ -338,5 +520,6 @@ void Input::applyRotation(Player *player) {
 }
 
 Input::~Input() {
+    Input::stopPolling();
     delete (m_repeatClock);
 }
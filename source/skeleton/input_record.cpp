@@ -0,0 +1,273 @@
+//
+// Created by cpasjuste on 17/10/2026.
+//
+
+#include "cross2d/c2d.h"
+
+using namespace c2d;
+
+static void putFloat(FILE *file, float f) {
+    uint32_t v;
+    memcpy(&v, &f, 4);
+    Utility::writeLE(file, v, 4);
+}
+
+static bool getFloat(FILE *file, float *f) {
+    uint64_t v;
+    if (!Utility::readLE(file, &v, 4)) {
+        return false;
+    }
+    auto bits = (uint32_t) v;
+    memcpy(f, &bits, 4);
+    return true;
+}
+
+static bool changed(const Input::Player &a, const Input::Player &b) {
+    return a.enabled != b.enabled || a.buttons != b.buttons
+           || a.lx.value != b.lx.value || a.ly.value != b.ly.value
+           || a.rx.value != b.rx.value || a.ry.value != b.ry.value || a.touch != b.touch;
+}
+
+bool InputRecord::writeHeader(FILE *file) {
+    fwrite("C2DI", 1, 4, file);
+    Utility::writeLE(file, Version, 2);
+    Utility::writeLE(file, PLAYER_MAX, 1);
+    return ferror(file) == 0;
+}
+
+bool InputRecord::readHeader(FILE *file) {
+    char magic[4];
+    uint64_t version, players;
+    if (fread(magic, 1, 4, file) != 4 || memcmp(magic, "C2DI", 4) != 0
+        || !Utility::readLE(file, &version, 2) || !Utility::readLE(file, &players, 1)) {
+        return false;
+    }
+
+    return version == Version && players == PLAYER_MAX;
+}
+
+bool InputRecord::writeFrame(FILE *file, const Input::Player *players, Input::Player *previous) {
+    uint8_t mask = 0;
+    for (int i = 0; i < PLAYER_MAX; i++) {
+        if (changed(players[i], previous[i])) {
+            mask |= (uint8_t) (1 << i);
+        }
+    }
+
+    Utility::writeLE(file, mask, 1);
+    for (int i = 0; i < PLAYER_MAX; i++) {
+        if (!(mask & (1 << i))) {
+            continue;
+        }
+        const Input::Player &p = players[i];
+        Utility::writeLE(file, p.enabled, 1);
+        Utility::writeLE(file, p.buttons, 4);
+        Utility::writeLE(file, (uint16_t) p.lx.value, 2);
+        Utility::writeLE(file, (uint16_t) p.ly.value, 2);
+        Utility::writeLE(file, (uint16_t) p.rx.value, 2);
+        Utility::writeLE(file, (uint16_t) p.ry.value, 2);
+        putFloat(file, p.touch.x);
+        putFloat(file, p.touch.y);
+
+        previous[i].enabled = p.enabled;
+        previous[i].buttons = p.buttons;
+        previous[i].lx.value = p.lx.value;
+        previous[i].ly.value = p.ly.value;
+        previous[i].rx.value = p.rx.value;
+        previous[i].ry.value = p.ry.value;
+        previous[i].touch = p.touch;
+    }
+
+    return ferror(file) == 0;
+}
+
+bool InputRecord::readFrame(FILE *file, Input::Player *players) {
+    uint64_t mask;
+    if (!Utility::readLE(file, &mask, 1)) {
+        return false;
+    }
+
+    for (int i = 0; i < PLAYER_MAX; i++) {
+        if (!(mask & (1u << i))) {
+            continue;
+        }
+        Input::Player &p = players[i];
+        uint64_t enabled, buttons, lx, ly, rx, ry;
+        if (!Utility::readLE(file, &enabled, 1) || !Utility::readLE(file, &buttons, 4)
+            || !Utility::readLE(file, &lx, 2) || !Utility::readLE(file, &ly, 2) || !Utility::readLE(file, &rx, 2) || !Utility::readLE(file, &ry, 2)
+            || !getFloat(file, &p.touch.x) || !getFloat(file, &p.touch.y)) {
+            return false;
+        }
+        p.enabled = enabled != 0;
+        p.buttons = (unsigned int) buttons;
+        p.lx.value = (short) lx;
+        p.ly.value = (short) ly;
+        p.rx.value = (short) rx;
+        p.ry.value = (short) ry;
+    }
+
+    return true;
+}
+
+InputRecorder::InputRecorder(Input *input, const std::string &path) : Input() {
+    m_input = input;
+
+    // mappings and configuration are the wrapped input ones
+    for (int i = 0; i < PLAYER_MAX; i++) {
+        m_players[i] = *m_input->getPlayer(i);
+        m_previous[i].enabled = false;
+    }
+    m_keyboard.mapping = m_input->getKeyboardMapping();
+    m_keyboard.mapping_default = m_input->getKeyboardMappingDefault();
+
+    m_file = fopen(path.c_str(), "wb");
+    if (!m_file || !InputRecord::writeHeader(m_file)) {
+        printf("InputRecorder: could not open %s for writing\n", path.c_str());
+        if (m_file) {
+            fclose(m_file);
+            m_file = nullptr;
+        }
+        return;
+    }
+
+    printf("InputRecorder: recording to %s\n", path.c_str());
+}
+
+Input::Player *InputRecorder::update() {
+    Player *players = m_input->update();
+
+    // only the state is copied, mappings are kept in sync by setJoystickMapping
+    for (int i = 0; i < PLAYER_MAX; i++) {
+        m_players[i].enabled = players[i].enabled;
+        m_players[i].buttons = players[i].buttons;
+        m_players[i].lx.value = players[i].lx.value;
+        m_players[i].ly.value = players[i].ly.value;
+        m_players[i].rx.value = players[i].rx.value;
+        m_players[i].ry.value = players[i].ry.value;
+        m_players[i].touch = players[i].touch;
+    }
+
+    if (m_file) {
+        InputRecord::writeFrame(m_file, m_players, m_previous);
+    }
+
+    return m_players;
+}
+
+int InputRecorder::waitButton(int player) {
+    return m_input->waitButton(player);
+}
+
+const std::vector<Input::Event> &InputRecorder::getEvents() {
+    return m_input->getEvents();
+}
+
+unsigned int InputRecorder::getPressed(int player) {
+    return m_input->getPressed(player);
+}
+
+unsigned int InputRecorder::getReleased(int player) {
+    return m_input->getReleased(player);
+}
+
+std::vector<Input::ButtonMapping> InputRecorder::getKeyboardMapping() {
+    return m_input->getKeyboardMapping();
+}
+
+std::vector<Input::ButtonMapping> InputRecorder::getKeyboardMappingDefault() {
+    return m_input->getKeyboardMappingDefault();
+}
+
+void InputRecorder::setRepeatDelay(int ms) {
+    m_input->setRepeatDelay(ms);
+}
+
+int InputRecorder::getRepeatDelay() {
+    return m_input->getRepeatDelay();
+}
+
+void InputRecorder::setRotation(const Rotation &dirRotation, const Rotation &buttonRotation) {
+    m_input->setRotation(dirRotation, buttonRotation);
+}
+
+Input::Rotation InputRecorder::getDirRotation() {
+    return m_input->getDirRotation();
+}
+
+Input::Rotation InputRecorder::getButtonRotation() {
+    return m_input->getButtonRotation();
+}
+
+void InputRecorder::setJoystickMapping(int player, const std::vector<ButtonMapping> &mapping,
+                                       const Vector2i &leftAxis, const Vector2i &rightAxis, int dz) {
+    m_input->setJoystickMapping(player, mapping, leftAxis, rightAxis, dz);
+    Input::setJoystickMapping(player, mapping, leftAxis, rightAxis, dz);
+}
+
+void InputRecorder::setKeyboardMapping(const std::vector<ButtonMapping> &mapping) {
+    m_input->setKeyboardMapping(mapping);
+    Input::setKeyboardMapping(mapping);
+}
+
+InputRecorder::~InputRecorder() {
+    if (m_file) {
+        fclose(m_file);
+    }
+
+    delete (m_input);
+}
+
+InputReplay::InputReplay(const std::string &path) : Input() {
+    m_file = fopen(path.c_str(), "rb");
+    if (!m_file || !InputRecord::readHeader(m_file)) {
+        printf("InputReplay: could not open %s (or not an input record)\n", path.c_str());
+        if (m_file) {
+            fclose(m_file);
+            m_file = nullptr;
+        }
+        m_finished = true;
+        return;
+    }
+
+    printf("InputReplay: replaying %s\n", path.c_str());
+}
+
+Input::Player *InputReplay::update() {
+    clearEvents();
+
+    if (!m_finished && InputRecord::readFrame(m_file, m_players)) {
+        m_frame++;
+    } else {
+        m_finished = true;
+        for (auto &player: m_players) {
+            player.buttons = 0;
+        }
+        m_players[0].buttons = Input::Button::Quit;
+    }
+
+    int64_t time = getTime();
+    for (int i = 0; i < PLAYER_MAX; i++) {
+        pushEvents(i, m_previous[i], m_players[i].buttons, time);
+        m_previous[i] = m_players[i].buttons;
+    }
+
+    return m_players;
+}
+
+int InputReplay::waitButton(int player) {
+    return -1;
+}
+
+int InputReplay::getFrame() {
+    return m_frame;
+}
+
+bool InputReplay::isFinished() {
+    return m_finished;
+}
+
+InputReplay::~InputReplay() {
+    if (m_file) {
+        fclose(m_file);
+    }
+}
@@ -0,0 +1,282 @@
+//
+// Created by cpasjuste on 17/10/2026.
+//
+
+#include "cross2d/c2d.h"
+
+using namespace c2d;
+
+AsyncIo::AsyncIo(Io *io, int threads) {
+    m_io = io;
+    m_mutex = new C2DMutex();
+    m_pool = new ThreadPool(threads > 0 ? threads : 1);
+}
+
+AsyncIo::Handle AsyncIo::submit(Request *request) {
+    m_mutex->lock();
+    request->handle = m_next++;
+    m_requests[request->handle] = request;
+    Handle handle = request->handle;
+    if (m_closing) {
+        // submitted by a callback delivered from the destructor, it will never run
+        request->cancelled = true;
+        complete(request);
+        m_mutex->unlock();
+        return handle;
+    }
+    m_queues[(int) request->priority].push_back(request);
+    m_mutex->unlock();
+
+    // one pool task per request, each one runs the most important request pending
+    // when it starts, not necessarily the one it was pushed for
+    m_pool->push([this](int) {
+        run();
+    });
+
+    return handle;
+}
+
+void AsyncIo::run() {
+    m_mutex->lock();
+    Request *request = nullptr;
+    for (int p = (int) Priority::High; p >= (int) Priority::Low && !request; p--) {
+        if (!m_queues[p].empty()) {
+            request = m_queues[p].front();
+            m_queues[p].pop_front();
+        }
+    }
+    if (!request) {
+        // cancelled meanwhile
+        m_mutex->unlock();
+        return;
+    }
+    request->status = Status::Running;
+    m_running++;
+    m_mutex->unlock();
+
+    execute(request);
+
+    m_mutex->lock();
+    m_running--;
+    complete(request);
+    m_mutex->unlock();
+}
+
+void AsyncIo::execute(Request *request) {
+    Result &result = request->result;
+
+    switch (request->op) {
+        case Op::Read: {
+            size_t size = request->size;
+            if (size == 0) {
+                size = m_io->getSize(request->path);
+                size = size > request->offset ? size - request->offset : 0;
+            }
+            if (size == 0) {
+                // empty (or missing) file
+                result.success = m_io->exist(request->path);
+                break;
+            }
+            result.data.resize(size);
+            size_t read = m_io->read(request->path, result.data.data(), size, request->offset);
+            result.success = read != (size_t) -1;
+            result.data.resize(result.success ? read : 0);
+            break;
+        }
+        case Op::Write:
+            result.success = m_io->write(request->path, request->data.data(), request->data.size());
+            std::vector<char>().swap(request->data);
+            break;
+        case Op::Copy:
+            result.success = m_io->copy(request->path, request->path2);
+            break;
+        case Op::DirList:
+            result.files = m_io->getDirList(request->path, request->sort, request->showHidden);
+            result.success = true;
+            break;
+        case Op::FindFiles:
+            result.files = m_io->findFiles(request->path, request->whitelist,
+                                           request->path2, request->stopOnFirst);
+            result.success = true;
+            break;
+    }
+}
+
+// locked
+void AsyncIo::complete(Request *request) {
+    if (request->cancelled) {
+        request->status = Status::Cancelled;
+        request->result = Result();
+    } else {
+        request->status = Status::Completed;
+    }
+    request->result.handle = request->handle;
+    request->result.status = request->status;
+    m_completed.push_back(request);
+}
+
+AsyncIo::Handle AsyncIo::read(const std::string &file, const Callback &callback,
+                              Priority priority, size_t size, size_t offset) {
+    auto request = new Request();
+    request->op = Op::Read;
+    request->path = file;
+    request->size = size;
+    request->offset = offset;
+    request->callback = callback;
+    request->priority = priority;
+    return submit(request);
+}
+
+AsyncIo::Handle AsyncIo::write(const std::string &file, std::vector<char> data,
+                               const Callback &callback, Priority priority) {
+    auto request = new Request();
+    request->op = Op::Write;
+    request->path = file;
+    request->data = std::move(data);
+    request->callback = callback;
+    request->priority = priority;
+    return submit(request);
+}
+
+AsyncIo::Handle AsyncIo::copy(const std::string &src, const std::string &dst,
+                              const Callback &callback, Priority priority) {
+    auto request = new Request();
+    request->op = Op::Copy;
+    request->path = src;
+    request->path2 = dst;
+    request->callback = callback;
+    request->priority = priority;
+    return submit(request);
+}
+
+AsyncIo::Handle AsyncIo::getDirList(const std::string &path, bool sort, bool showHidden,
+                                    const Callback &callback, Priority priority) {
+    auto request = new Request();
+    request->op = Op::DirList;
+    request->path = path;
+    request->sort = sort;
+    request->showHidden = showHidden;
+    request->callback = callback;
+    request->priority = priority;
+    return submit(request);
+}
+
+AsyncIo::Handle AsyncIo::findFiles(const std::string &path, const std::vector<std::string> &whitelist,
+                                   const std::string &blacklist, bool stopOnFirst,
+                                   const Callback &callback, Priority priority) {
+    auto request = new Request();
+    request->op = Op::FindFiles;
+    request->path = path;
+    request->path2 = blacklist;
+    request->whitelist = whitelist;
+    request->stopOnFirst = stopOnFirst;
+    request->callback = callback;
+    request->priority = priority;
+    return submit(request);
+}
+
+bool AsyncIo::cancel(Handle handle) {
+    m_mutex->lock();
+    auto it = m_requests.find(handle);
+    if (it == m_requests.end() || it->second->cancelled
+        || it->second->status == Status::Completed || it->second->status == Status::Cancelled) {
+        m_mutex->unlock();
+        return false;
+    }
+
+    Request *request = it->second;
+    request->cancelled = true;
+    if (request->status == Status::Pending) {
+        auto &queue = m_queues[(int) request->priority];
+        queue.erase(std::find(queue.begin(), queue.end(), request));
+        complete(request);
+    }
+    // else running, the result is dropped on completion
+    m_mutex->unlock();
+
+    return true;
+}
+
+void AsyncIo::cancelAll() {
+    m_mutex->lock();
+    for (auto &it: m_requests) {
+        Request *request = it.second;
+        if (request->status == Status::Pending || request->status == Status::Running) {
+            request->cancelled = true;
+        }
+    }
+    for (auto &queue: m_queues) {
+        for (auto request: queue) {
+            complete(request);
+        }
+        queue.clear();
+    }
+    m_mutex->unlock();
+}
+
+AsyncIo::Status AsyncIo::getStatus(Handle handle) {
+    m_mutex->lock();
+    auto it = m_requests.find(handle);
+    Status status = it != m_requests.end() ? it->second->status : Status::Unknown;
+    m_mutex->unlock();
+
+    return status;
+}
+
+int AsyncIo::getPending() {
+    m_mutex->lock();
+    int pending = m_running;
+    for (auto &queue: m_queues) {
+        pending += (int) queue.size();
+    }
+    m_mutex->unlock();
+
+    return pending;
+}
+
+int AsyncIo::dispatch() {
+    std::vector<Request *> completed;
+
+    m_mutex->lock();
+    if (m_completed.empty()) {
+        m_mutex->unlock();
+        return 0;
+    }
+    completed.swap(m_completed);
+    for (auto request: completed) {
+        m_requests.erase(request->handle);
+    }
+    m_mutex->unlock();
+
+    // callbacks may submit new requests, nothing is locked here
+    for (auto request: completed) {
+        if (request->callback) {
+            request->callback(request->result);
+        }
+        delete (request);
+    }
+
+    return (int) completed.size();
+}
+
+void AsyncIo::wait() {
+    m_pool->wait();
+}
+
+AsyncIo::~AsyncIo() {
+    m_mutex->lock();
+    m_closing = true;
+    m_mutex->unlock();
+
+    // running requests complete before the pool is destroyed, then every callback is
+    // delivered (Cancelled, unless the request completed before), on the calling thread
+    cancelAll();
+    delete (m_pool);
+    while (dispatch() > 0) {
+    }
+
+    for (auto &it: m_requests) {
+        delete (it.second);
+    }
+    delete (m_mutex);
+}
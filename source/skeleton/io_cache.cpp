@@ -0,0 +1,510 @@
+//
+// Created by cpasjuste on 17/10/2026.
+//
+
+#include <cstring>
+
+#include "cross2d/c2d.h"
+
+#if defined(__LINUX__) || defined(__ANDROID__)
+#define C2D_IO_INOTIFY
+#include <unistd.h>
+#include <sys/inotify.h>
+#define C2D_IO_INOTIFY_MASK (IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_MODIFY \
+                            | IN_CLOSE_WRITE | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR)
+#endif
+
+using namespace c2d;
+
+static void putString(FILE *file, const std::string &str) {
+    Utility::writeLE(file, str.size(), 4);
+    fwrite(str.data(), 1, str.size(), file);
+}
+
+static bool getString(FILE *file, std::string *str) {
+    uint64_t len;
+    if (!Utility::readLE(file, &len, 4) || len > 4096) {
+        return false;
+    }
+    str->resize((size_t) len);
+    return len == 0 || fread(&(*str)[0], 1, (size_t) len, file) == len;
+}
+
+CachedIo::CachedIo(Io *io) : Io() {
+    m_io = io;
+    m_mutex = new C2DMutex();
+#ifdef C2D_IO_INOTIFY
+    m_inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_inotify < 0) {
+        printf("CachedIo: inotify not available (%s), using modification times\n", strerror(errno));
+    }
+#endif
+}
+
+Io *CachedIo::getIo() {
+    return m_io;
+}
+
+std::string CachedIo::key(const std::string &path) {
+    if (path.length() > 1 && path.back() == '/') {
+        return path.substr(0, path.length() - 1);
+    }
+    return path;
+}
+
+void CachedIo::readEvents() {
+#ifdef C2D_IO_INOTIFY
+    if (m_inotify < 0) {
+        return;
+    }
+
+    alignas(struct inotify_event) char buffer[4096];
+    ssize_t len;
+    while ((len = ::read(m_inotify, buffer, sizeof(buffer))) > 0) {
+        for (char *p = buffer; p < buffer + len;) {
+            auto *event = (struct inotify_event *) p;
+            p += sizeof(struct inotify_event) + event->len;
+            if (event->mask & IN_Q_OVERFLOW) {
+                // events were lost, nothing can be trusted
+                clearLocked();
+                return;
+            }
+            auto it = m_watches.find(event->wd);
+            if (it == m_watches.end()) {
+                continue;
+            }
+            // a copy, invalidation updates m_watches
+            std::vector<std::string> paths = it->second;
+            for (const auto &path: paths) {
+                invalidateLocked(path);
+            }
+        }
+    }
+#endif
+}
+
+void CachedIo::unwatch(Dir *dir) {
+#ifdef C2D_IO_INOTIFY
+    if (dir->watch < 0) {
+        return;
+    }
+
+    // the same directory may be cached under different paths (links), sharing a watch
+    auto it = m_watches.find(dir->watch);
+    if (it != m_watches.end()) {
+        for (auto &path: it->second) {
+            auto d = m_dirs.find(path);
+            if (d != m_dirs.end() && &d->second == dir) {
+                it->second.erase(std::find(it->second.begin(), it->second.end(), path));
+                break;
+            }
+        }
+        if (it->second.empty()) {
+            inotify_rm_watch(m_inotify, dir->watch);
+            m_watches.erase(it);
+        }
+    }
+    dir->watch = -1;
+#endif
+}
+
+void CachedIo::watch(const std::string &path, Dir *dir) {
+#ifdef C2D_IO_INOTIFY
+    if (dir->watch < 0 && m_inotify >= 0) {
+        dir->watch = inotify_add_watch(m_inotify, path.c_str(), C2D_IO_INOTIFY_MASK);
+        if (dir->watch >= 0) {
+            m_watches[dir->watch].push_back(path);
+        }
+    }
+#endif
+}
+
+bool CachedIo::isValid(const std::string &path, Dir *dir) {
+    if (dir->watch >= 0 && dir->validated) {
+        // pending events were read, nothing changed
+        return true;
+    }
+
+    // watch before checking, so a change made right after the check is not missed
+    watch(path, dir);
+
+    int64_t mtime = m_io->getModificationTime(path);
+    if (mtime < 0 || mtime != dir->mtime) {
+        return false;
+    }
+
+    dir->validated = true;
+    return true;
+}
+
+std::vector<Io::File> CachedIo::getDirList(const std::string &path, bool sort, bool showHidden) {
+    std::string k = key(path);
+    int list = (sort ? 2 : 0) + (showHidden ? 1 : 0);
+
+    m_mutex->lock();
+    readEvents();
+
+    auto it = m_dirs.find(k);
+    if (it != m_dirs.end()) {
+        Dir &dir = it->second;
+        if (isValid(k, &dir)) {
+            if (dir.listed[list]) {
+                m_stats.hits++;
+                std::vector<File> files = dir.lists[list];
+                m_mutex->unlock();
+                return files;
+            }
+        } else {
+            // changed since it was cached, drop the other listings too
+            for (int i = 0; i < 4; i++) {
+                dir.lists[i].clear();
+                dir.listed[i] = false;
+            }
+            dir.validated = true;
+            m_stats.invalidations++;
+        }
+    }
+
+    Dir &dir = m_dirs[k];
+    watch(k, &dir);
+    // time taken before the listing, a change made while listing will be caught by the next access
+    dir.mtime = m_io->getModificationTime(k);
+    int64_t mtime = dir.mtime;
+    m_stats.misses++;
+    m_mutex->unlock();
+
+    // list without holding the lock, other directories can be served meanwhile
+    std::vector<File> files = m_io->getDirList(path, sort, showHidden);
+
+    m_mutex->lock();
+    readEvents();
+    it = m_dirs.find(k);
+    // not cached if invalidated while listing, or if the directory doesn't exist
+    if (it != m_dirs.end() && it->second.mtime == mtime) {
+        if (mtime >= 0) {
+            it->second.lists[list] = files;
+            it->second.listed[list] = true;
+        } else {
+            invalidateLocked(k);
+        }
+    }
+    m_mutex->unlock();
+
+    return files;
+}
+
+void CachedIo::invalidateLocked(const std::string &path) {
+    auto it = m_dirs.find(path);
+    if (it == m_dirs.end()) {
+        return;
+    }
+
+    unwatch(&it->second);
+    m_dirs.erase(it);
+    m_stats.invalidations++;
+}
+
+void CachedIo::invalidate(const std::string &path) {
+    m_mutex->lock();
+    invalidateLocked(key(path));
+    m_mutex->unlock();
+}
+
+void CachedIo::invalidateParent(const std::string &path) {
+    std::string k = key(path);
+    size_t pos = k.find_last_of('/');
+    std::string parent = pos == std::string::npos ? "." : pos == 0 ? "/" : k.substr(0, pos);
+
+    m_mutex->lock();
+    invalidateLocked(k);
+    invalidateLocked(parent);
+    // sub directories of a removed/replaced directory
+    std::string prefix = k + "/";
+    std::vector<std::string> children;
+    for (auto it = m_dirs.lower_bound(prefix);
+         it != m_dirs.end() && it->first.compare(0, prefix.length(), prefix) == 0; ++it) {
+        children.push_back(it->first);
+    }
+    for (const auto &child: children) {
+        invalidateLocked(child);
+    }
+    m_mutex->unlock();
+}
+
+void CachedIo::clear() {
+    m_mutex->lock();
+    clearLocked();
+    m_mutex->unlock();
+}
+
+void CachedIo::clearLocked() {
+#ifdef C2D_IO_INOTIFY
+    for (const auto &watch: m_watches) {
+        inotify_rm_watch(m_inotify, watch.first);
+    }
+#endif
+    m_watches.clear();
+    m_dirs.clear();
+}
+
+bool CachedIo::saveSnapshot(const std::string &file) {
+    FILE *f = fopen(file.c_str(), "wb");
+    if (!f) {
+        printf("CachedIo::saveSnapshot: could not open %s for writing\n", file.c_str());
+        return false;
+    }
+
+    m_mutex->lock();
+    fwrite("C2DC", 1, 4, f);
+    Utility::writeLE(f, SnapshotVersion, 4);
+    Utility::writeLE(f, m_dirs.size(), 4);
+    for (const auto &it: m_dirs) {
+        const Dir &dir = it.second;
+        uint8_t listed = 0;
+        for (int i = 0; i < 4; i++) {
+            if (dir.listed[i]) listed |= (uint8_t) (1 << i);
+        }
+        putString(f, it.first);
+        Utility::writeLE(f, (uint64_t) dir.mtime, 8);
+        Utility::writeLE(f, listed, 1);
+        for (int i = 0; i < 4; i++) {
+            if (!dir.listed[i]) continue;
+            Utility::writeLE(f, dir.lists[i].size(), 4);
+            for (const auto &entry: dir.lists[i]) {
+                putString(f, entry.name);
+                Utility::writeLE(f, (uint8_t) entry.type, 1);
+                Utility::writeLE(f, entry.resolved, 1);
+                Utility::writeLE(f, entry.size, 8);
+            }
+        }
+    }
+    m_mutex->unlock();
+
+    bool ok = ferror(f) == 0;
+    fclose(f);
+
+    return ok;
+}
+
+bool CachedIo::loadSnapshot(const std::string &file) {
+    FILE *f = fopen(file.c_str(), "rb");
+    if (!f) {
+        return false;
+    }
+
+    char magic[4];
+    uint64_t version, count;
+    if (fread(magic, 1, 4, f) != 4 || memcmp(magic, "C2DC", 4) != 0
+        || !Utility::readLE(f, &version, 4) || version != SnapshotVersion || !Utility::readLE(f, &count, 4)) {
+        printf("CachedIo::loadSnapshot: %s is not a snapshot (or an old one)\n", file.c_str());
+        fclose(f);
+        return false;
+    }
+
+    // read everything first, a truncated snapshot is not used
+    std::vector<std::pair<std::string, Dir>> dirs;
+    bool ok = true;
+    for (uint64_t d = 0; d < count && ok; d++) {
+        std::pair<std::string, Dir> entry;
+        Dir &dir = entry.second;
+        uint64_t mtime, listed;
+        if (!getString(f, &entry.first) || !Utility::readLE(f, &mtime, 8) || !Utility::readLE(f, &listed, 1)) {
+            ok = false;
+            break;
+        }
+        dir.mtime = (int64_t) mtime;
+        dir.validated = false;
+        std::string base = Utility::removeLastSlash(entry.first) + "/";
+        for (int i = 0; i < 4 && ok; i++) {
+            if (!(listed & (1u << i))) continue;
+            uint64_t n;
+            if (!Utility::readLE(f, &n, 4)) {
+                ok = false;
+                break;
+            }
+            dir.listed[i] = true;
+            dir.lists[i].resize((size_t) n);
+            for (auto &file: dir.lists[i]) {
+                uint64_t type, resolved, size;
+                if (!getString(f, &file.name) || !Utility::readLE(f, &type, 1)
+                    || !Utility::readLE(f, &resolved, 1) || !Utility::readLE(f, &size, 8) || type > (uint64_t) Type::Directory) {
+                    ok = false;
+                    break;
+                }
+                file.path = base + file.name;
+                file.type = (Type) type;
+                file.resolved = resolved != 0;
+                file.size = (size_t) size;
+            }
+        }
+        dirs.push_back(std::move(entry));
+    }
+    fclose(f);
+
+    if (!ok) {
+        printf("CachedIo::loadSnapshot: %s is truncated or corrupted\n", file.c_str());
+        return false;
+    }
+
+    m_mutex->lock();
+    for (auto &dir: dirs) {
+        // what is already cached is more recent
+        if (m_dirs.find(dir.first) == m_dirs.end()) {
+            m_dirs[dir.first] = std::move(dir.second);
+        }
+    }
+    m_mutex->unlock();
+
+    return true;
+}
+
+CachedIo::CacheStats CachedIo::getCacheStats() {
+    m_mutex->lock();
+    CacheStats stats = m_stats;
+    m_mutex->unlock();
+    return stats;
+}
+
+std::string CachedIo::getRomFsPath() {
+    return m_io->getRomFsPath();
+}
+
+std::string CachedIo::getDataPath() {
+    return m_io->getDataPath();
+}
+
+void CachedIo::setDataPath(const std::string &path) {
+    m_io->setDataPath(path);
+}
+
+Io::File CachedIo::getFile(const std::string &path) {
+    return m_io->getFile(path);
+}
+
+bool CachedIo::exist(const std::string &path) {
+    return m_io->exist(path);
+}
+
+size_t CachedIo::getSize(const std::string &file) {
+    return m_io->getSize(file);
+}
+
+Io::Type CachedIo::getType(const std::string &file) {
+    return m_io->getType(file);
+}
+
+int64_t CachedIo::getModificationTime(const std::string &path) {
+    return m_io->getModificationTime(path);
+}
+
+bool CachedIo::create(const std::string &path) {
+    bool res = m_io->create(path);
+    invalidateParent(path);
+    return res;
+}
+
+bool CachedIo::removeFile(const std::string &path) {
+    bool res = m_io->removeFile(path);
+    invalidateParent(path);
+    return res;
+}
+
+bool CachedIo::removeDir(const std::string &path) {
+    bool res = m_io->removeDir(path);
+    invalidateParent(path);
+    return res;
+}
+
+bool CachedIo::copy(const std::string &src, const std::string &dst,
+                    const std::function<void(File, File, float)> &callback) {
+    bool res = m_io->copy(src, dst, callback);
+    invalidateParent(dst);
+    return res;
+}
+
+std::vector<Io::File> CachedIo::findFiles(const std::string &path, const std::vector<std::string> &whitelist,
+                                          const std::string &blacklist, bool stopOnFirst) {
+    return m_io->findFiles(path, whitelist, blacklist, stopOnFirst);
+}
+
+size_t CachedIo::findFilesRecursive(const std::string &path, const std::vector<std::string> &extensions,
+                                    const std::function<bool(const File &file)> &callback,
+                                    const std::string &blacklist) {
+    return m_io->findFilesRecursive(path, extensions, callback, blacklist);
+}
+
+size_t CachedIo::read(const std::string &file, char *out, size_t size, size_t offset) {
+    return m_io->read(file, out, size, offset);
+}
+
+bool CachedIo::write(const std::string &file, const char *data, size_t size) {
+    bool res = m_io->write(file, data, size);
+    invalidateParent(file);
+    return res;
+}
+
+Io::Map *CachedIo::map(const std::string &file, Advice advice) {
+    return m_io->map(file, advice);
+}
+
+bool CachedIo::isMappable(const std::string &file) {
+    return m_io->isMappable(file);
+}
+
+void CachedIo::setCopyThreads(int threads) {
+    m_io->setCopyThreads(threads);
+}
+
+int CachedIo::getCopyThreads() {
+    return m_io->getCopyThreads();
+}
+
+void CachedIo::setScanThreads(int threads) {
+    m_io->setScanThreads(threads);
+}
+
+int CachedIo::getScanThreads() {
+    return m_io->getScanThreads();
+}
+
+Io::CopyStats CachedIo::getCopyStats() {
+    return m_io->getCopyStats();
+}
+
+void CachedIo::resetCopyStats() {
+    m_io->resetCopyStats();
+}
+
+Io::ListStats CachedIo::getListStats() {
+    return m_io->getListStats();
+}
+
+void CachedIo::resetListStats() {
+    m_io->resetListStats();
+}
+
+void CachedIo::setDeferredStat(bool enable) {
+    if (enable != m_io->getDeferredStat()) {
+        // cached entries were listed with the other mode
+        clear();
+    }
+    m_io->setDeferredStat(enable);
+}
+
+bool CachedIo::getDeferredStat() {
+    return m_io->getDeferredStat();
+}
+
+bool CachedIo::resolve(File *file) {
+    return m_io->resolve(file);
+}
+
+CachedIo::~CachedIo() {
+#ifdef C2D_IO_INOTIFY
+    if (m_inotify >= 0) {
+        close(m_inotify);
+    }
+#endif
+    delete (m_mutex);
+    delete (m_io);
+}
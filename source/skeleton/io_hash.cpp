@@ -0,0 +1,408 @@
+//
+// Created by cpasjuste on 17/10/2026.
+//
+
+#include <cstring>
+#include "cross2d/c2d.h"
+
+#ifndef __PS3__
+#define C2D_HASH_ZLIB
+#include <zlib.h>
+#endif
+
+using namespace c2d;
+
+static std::string toHex(const uint8_t *data, size_t size) {
+    static const char *digits = "0123456789abcdef";
+    std::string str(size * 2, '0');
+    for (size_t i = 0; i < size; i++) {
+        str[i * 2] = digits[data[i] >> 4];
+        str[i * 2 + 1] = digits[data[i] & 0x0F];
+    }
+    return str;
+}
+
+std::string IoHasher::Hash::getCrcString() const {
+    if (!(algorithms & Crc32)) {
+        return "";
+    }
+    uint8_t b[4] = {(uint8_t) (crc >> 24), (uint8_t) (crc >> 16), (uint8_t) (crc >> 8), (uint8_t) crc};
+    return toHex(b, 4);
+}
+
+std::string IoHasher::Hash::getSha1String() const {
+    return algorithms & Sha1 ? toHex(sha1, 20) : "";
+}
+
+IoHasher::IoHasher(Io *io, int threads) {
+    m_io = io;
+    m_mutex = new C2DMutex();
+    m_pool = new ThreadPool(threads);
+}
+
+uint32_t IoHasher::crc32(uint32_t crc, const uint8_t *data, size_t size) {
+#ifdef C2D_HASH_ZLIB
+    // zlib length is an uInt, and its crc32 is already sliced (several bytes per step)
+    while (size > 0) {
+        auto len = (uInt) (size > 0x40000000 ? 0x40000000 : size);
+        crc = (uint32_t) ::crc32(crc, data, len);
+        data += len;
+        size -= len;
+    }
+    return crc;
+#else
+    static uint32_t table[256];
+    static bool init = false;
+    if (!init) {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) {
+                c = c & 1 ? 0xEDB88320 ^ (c >> 1) : c >> 1;
+            }
+            table[i] = c;
+        }
+        init = true;
+    }
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++) {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+#endif
+}
+
+#define ROL(v, n) (((v) << (n)) | ((v) >> (32 - (n))))
+// message schedule kept in a 16 words ring
+#define W(i) ((i) < 16 ? w[i] : (w[(i) & 15] = ROL(w[((i) + 13) & 15] ^ w[((i) + 8) & 15] \
+                                               ^ w[((i) + 2) & 15] ^ w[(i) & 15], 1)))
+#define F0(b, c, d) ((d) ^ ((b) & ((c) ^ (d))))
+#define F1(b, c, d) ((b) ^ (c) ^ (d))
+#define F2(b, c, d) (((b) & (c)) | ((d) & ((b) | (c))))
+#define R(a, b, c, d, e, f, k, i) e += ROL(a, 5) + f(b, c, d) + (k) + W(i); b = ROL(b, 30);
+// five rounds rotate the variables back in place, no copies between rounds
+#define R5(f, k, i) R(a, b, c, d, e, f, k, i) R(e, a, b, c, d, f, k, (i) + 1) R(d, e, a, b, c, f, k, (i) + 2) \
+                    R(c, d, e, a, b, f, k, (i) + 3) R(b, c, d, e, a, f, k, (i) + 4)
+
+void IoHasher::sha1Transform(uint32_t *state, const uint8_t *block) {
+    uint32_t w[16];
+    for (int i = 0; i < 16; i++) {
+        w[i] = (uint32_t) block[i * 4] << 24 | (uint32_t) block[i * 4 + 1] << 16
+               | (uint32_t) block[i * 4 + 2] << 8 | (uint32_t) block[i * 4 + 3];
+    }
+
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3], e = state[4];
+    R5(F0, 0x5A827999, 0) R5(F0, 0x5A827999, 5) R5(F0, 0x5A827999, 10) R5(F0, 0x5A827999, 15)
+    R5(F1, 0x6ED9EBA1, 20) R5(F1, 0x6ED9EBA1, 25) R5(F1, 0x6ED9EBA1, 30) R5(F1, 0x6ED9EBA1, 35)
+    R5(F2, 0x8F1BBCDC, 40) R5(F2, 0x8F1BBCDC, 45) R5(F2, 0x8F1BBCDC, 50) R5(F2, 0x8F1BBCDC, 55)
+    R5(F1, 0xCA62C1D6, 60) R5(F1, 0xCA62C1D6, 65) R5(F1, 0xCA62C1D6, 70) R5(F1, 0xCA62C1D6, 75)
+
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+}
+
+void IoHasher::sha1Init(Sha1Context *ctx) {
+    ctx->state[0] = 0x67452301;
+    ctx->state[1] = 0xEFCDAB89;
+    ctx->state[2] = 0x98BADCFE;
+    ctx->state[3] = 0x10325476;
+    ctx->state[4] = 0xC3D2E1F0;
+    ctx->length = 0;
+    ctx->used = 0;
+}
+
+void IoHasher::sha1Update(Sha1Context *ctx, const uint8_t *data, size_t size) {
+    ctx->length += size;
+
+    if (ctx->used > 0) {
+        size_t len = std::min(size, (size_t) 64 - ctx->used);
+        memcpy(ctx->buffer + ctx->used, data, len);
+        ctx->used += len;
+        data += len;
+        size -= len;
+        if (ctx->used < 64) {
+            return;
+        }
+        sha1Transform(ctx->state, ctx->buffer);
+        ctx->used = 0;
+    }
+
+    // whole blocks are hashed in place
+    while (size >= 64) {
+        sha1Transform(ctx->state, data);
+        data += 64;
+        size -= 64;
+    }
+
+    if (size > 0) {
+        memcpy(ctx->buffer, data, size);
+        ctx->used = size;
+    }
+}
+
+void IoHasher::sha1Final(Sha1Context *ctx, uint8_t *digest) {
+    uint64_t bits = ctx->length * 8;
+    uint8_t pad[72] = {0x80};
+    size_t len = ctx->used < 56 ? 56 - ctx->used : 120 - ctx->used;
+    for (int i = 0; i < 8; i++) {
+        pad[len + i] = (uint8_t) (bits >> ((7 - i) * 8));
+    }
+    // don't count the padding in the length
+    uint64_t length = ctx->length;
+    sha1Update(ctx, pad, len + 8);
+    ctx->length = length;
+
+    for (int i = 0; i < 5; i++) {
+        digest[i * 4] = (uint8_t) (ctx->state[i] >> 24);
+        digest[i * 4 + 1] = (uint8_t) (ctx->state[i] >> 16);
+        digest[i * 4 + 2] = (uint8_t) (ctx->state[i] >> 8);
+        digest[i * 4 + 3] = (uint8_t) ctx->state[i];
+    }
+}
+
+void IoHasher::sha1(const uint8_t *data, size_t size, uint8_t *digest) {
+    Sha1Context ctx{};
+    sha1Init(&ctx);
+    sha1Update(&ctx, data, size);
+    sha1Final(&ctx, digest);
+}
+
+IoHasher::Hash IoHasher::compute(const std::string &file, int algorithms, std::vector<uint8_t> *buffer) {
+    Hash hash;
+    hash.path = file;
+    hash.size = m_io->getSize(file);
+    hash.mtime = m_io->getModificationTime(file);
+    hash.algorithms = algorithms;
+
+    uint32_t crc = 0;
+    Sha1Context ctx{};
+    sha1Init(&ctx);
+    auto update = [&](const uint8_t *data, size_t size) {
+        if (algorithms & Crc32) crc = crc32(crc, data, size);
+        if (algorithms & Sha1) sha1Update(&ctx, data, size);
+    };
+
+    if (hash.size == 0 || hash.size == (size_t) -1) {
+        // empty or missing
+        hash.size = 0;
+        hash.success = m_io->getType(file) == Io::Type::File;
+    } else {
+        // mapped files are hashed without copy. Io::map reads the whole file in memory when the
+        // io can't map it (a deflated zip entry...), so such big files are read by chunks instead
+        Io::Map *map = nullptr;
+        if (hash.size <= C2D_IO_HASH_CHUNK_SIZE || m_io->isMappable(file)) {
+            map = m_io->map(file, Io::Advice::Sequential);
+        }
+
+        if (map) {
+            hash.size = map->getSize();
+            update(map->getData(), map->getSize());
+            hash.success = true;
+            delete (map);
+        } else {
+            if (buffer->size() < C2D_IO_HASH_CHUNK_SIZE) {
+                buffer->resize(C2D_IO_HASH_CHUNK_SIZE);
+            }
+            // consecutive chunks: a ZipIo resumes its inflate instead of starting over
+            size_t offset = 0;
+            hash.success = true;
+            while (offset < hash.size) {
+                size_t len = std::min(hash.size - offset, (size_t) C2D_IO_HASH_CHUNK_SIZE);
+                if (m_io->read(file, (char *) buffer->data(), len, offset) != len) {
+                    hash.success = false;
+                    break;
+                }
+                update(buffer->data(), len);
+                offset += len;
+            }
+        }
+    }
+
+    if (!hash.success) {
+        printf("IoHasher: could not read %s\n", file.c_str());
+        hash.algorithms = 0;
+        return hash;
+    }
+
+    hash.crc = crc;
+    sha1Final(&ctx, hash.sha1);
+    if (!(algorithms & Sha1)) {
+        memset(hash.sha1, 0, sizeof(hash.sha1));
+    }
+
+    return hash;
+}
+
+IoHasher::Hash IoHasher::hash(const std::string &file, int algorithms) {
+    return hash(std::vector<std::string>{file}, algorithms)[0];
+}
+
+std::vector<IoHasher::Hash> IoHasher::hash(const std::vector<std::string> &files, int algorithms,
+                                           const Callback &callback) {
+    int64_t start = Utility::getTimeUs();
+    std::vector<Hash> hashes(files.size());
+    std::vector<std::vector<uint8_t>> buffers((size_t) m_pool->getThreadCount());
+    size_t done = 0;
+
+    for (size_t i = 0; i < files.size(); i++) {
+        m_pool->push([&, i](int worker) {
+            const std::string &file = files[i];
+            Hash &hash = hashes[i];
+            bool cached = false;
+
+            // a stat to validate the cached entry, instead of reading the whole file
+            int64_t mtime = m_io->getModificationTime(file);
+            if (mtime >= 0) {
+                size_t size = m_io->getSize(file);
+                m_mutex->lock();
+                auto it = m_cache.find(file);
+                if (it != m_cache.end() && it->second.mtime == mtime && it->second.size == size
+                    && (it->second.algorithms & algorithms) == algorithms) {
+                    hash = it->second;
+                    cached = true;
+                }
+                m_mutex->unlock();
+            }
+
+            if (!cached) {
+                hash = compute(file, algorithms, &buffers[worker]);
+            }
+
+            m_mutex->lock();
+            if (cached) {
+                m_stats.cached++;
+            } else if (hash.success) {
+                m_stats.hashed++;
+                m_stats.bytes += hash.size;
+                if (hash.mtime >= 0) {
+                    m_cache[file] = hash;
+                }
+            }
+            done++;
+            if (callback) {
+                // serialized, the mutex is held
+                callback(hash, done, files.size());
+            }
+            m_mutex->unlock();
+        });
+    }
+
+    m_pool->wait();
+
+    m_mutex->lock();
+    m_stats.seconds += (double) (Utility::getTimeUs() - start) / 1000000.0;
+    m_mutex->unlock();
+
+    return hashes;
+}
+
+bool IoHasher::saveCache(const std::string &file) {
+    FILE *f = fopen(file.c_str(), "wb");
+    if (!f) {
+        printf("IoHasher::saveCache: could not open %s for writing\n", file.c_str());
+        return false;
+    }
+
+    m_mutex->lock();
+    fwrite("C2DH", 1, 4, f);
+    Utility::writeLE(f, CacheVersion, 4);
+    Utility::writeLE(f, m_cache.size(), 4);
+    for (const auto &it: m_cache) {
+        const Hash &hash = it.second;
+        Utility::writeLE(f, hash.path.size(), 4);
+        fwrite(hash.path.data(), 1, hash.path.size(), f);
+        Utility::writeLE(f, hash.size, 8);
+        Utility::writeLE(f, (uint64_t) hash.mtime, 8);
+        Utility::writeLE(f, (uint64_t) hash.algorithms, 1);
+        Utility::writeLE(f, hash.crc, 4);
+        fwrite(hash.sha1, 1, sizeof(hash.sha1), f);
+    }
+    m_mutex->unlock();
+
+    bool ok = ferror(f) == 0;
+    fclose(f);
+
+    return ok;
+}
+
+bool IoHasher::loadCache(const std::string &file) {
+    FILE *f = fopen(file.c_str(), "rb");
+    if (!f) {
+        return false;
+    }
+
+    char magic[4];
+    uint64_t version, count;
+    if (fread(magic, 1, 4, f) != 4 || memcmp(magic, "C2DH", 4) != 0
+        || !Utility::readLE(f, &version, 4) || version != CacheVersion || !Utility::readLE(f, &count, 4)) {
+        printf("IoHasher::loadCache: %s is not a hash cache (or an old one)\n", file.c_str());
+        fclose(f);
+        return false;
+    }
+
+    // read everything first, a truncated cache is not used
+    std::vector<Hash> hashes;
+    bool ok = true;
+    for (uint64_t i = 0; i < count; i++) {
+        Hash hash;
+        uint64_t len, size, mtime, algorithms, crc;
+        if (!Utility::readLE(f, &len, 4) || len > 4096) {
+            ok = false;
+            break;
+        }
+        hash.path.resize((size_t) len);
+        if ((len > 0 && fread(&hash.path[0], 1, (size_t) len, f) != len)
+            || !Utility::readLE(f, &size, 8) || !Utility::readLE(f, &mtime, 8) || !Utility::readLE(f, &algorithms, 1) || !Utility::readLE(f, &crc, 4)
+            || fread(hash.sha1, 1, sizeof(hash.sha1), f) != sizeof(hash.sha1)) {
+            ok = false;
+            break;
+        }
+        hash.size = (size_t) size;
+        hash.mtime = (int64_t) mtime;
+        hash.algorithms = (int) algorithms;
+        hash.crc = (uint32_t) crc;
+        hash.success = true;
+        hashes.push_back(hash);
+    }
+    fclose(f);
+
+    if (!ok) {
+        printf("IoHasher::loadCache: %s is truncated\n", file.c_str());
+        return false;
+    }
+
+    m_mutex->lock();
+    for (auto &hash: hashes) {
+        m_cache[hash.path] = hash;
+    }
+    m_mutex->unlock();
+
+    return true;
+}
+
+void IoHasher::clearCache() {
+    m_mutex->lock();
+    m_cache.clear();
+    m_mutex->unlock();
+}
+
+IoHasher::HashStats IoHasher::getStats() {
+    m_mutex->lock();
+    HashStats stats = m_stats;
+    m_mutex->unlock();
+
+    return stats;
+}
+
+void IoHasher::resetStats() {
+    m_mutex->lock();
+    m_stats = HashStats();
+    m_mutex->unlock();
+}
+
+IoHasher::~IoHasher() {
+    delete (m_pool);
+    delete (m_mutex);
+}
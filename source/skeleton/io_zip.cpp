@@ -0,0 +1,841 @@
+//
+// Created by cpasjuste on 17/10/2026.
+//
+
+#include <cstring>
+#include <ctime>
+#include "cross2d/c2d.h"
+
+#ifndef __PS3__
+#define C2D_ZIP_INFLATE
+#include <zlib.h>
+#endif
+
+#if defined(__LINUX__) || defined(__ANDROID__) || defined(__APPLE__)
+// the archive is mapped (Io::map) instead of being read by offsets
+#define C2D_ZIP_MMAP
+#endif
+
+#define ZIP_LOCAL_HEADER_SIG 0x04034b50
+#define ZIP_CENTRAL_HEADER_SIG 0x02014b50
+#define ZIP_END_SIG 0x06054b50
+#define ZIP64_END_SIG 0x06064b50
+#define ZIP64_LOCATOR_SIG 0x07064b50
+#define ZIP_METHOD_STORED 0
+#define ZIP_METHOD_DEFLATED 8
+#define ZIP_READ_CHUNK (64 * 1024)
+// inflate streams kept for the next chunk, at least one per concurrent reader
+#define ZIP_STREAMS_MAX 16
+
+using namespace c2d;
+
+static inline uint16_t rd16(const uint8_t *p) {
+    return (uint16_t) (p[0] | (p[1] << 8));
+}
+
+static inline uint32_t rd32(const uint8_t *p) {
+    return (uint32_t) p[0] | ((uint32_t) p[1] << 8) | ((uint32_t) p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+static inline uint64_t rd64(const uint8_t *p) {
+    return (uint64_t) rd32(p) | ((uint64_t) rd32(p + 4) << 32);
+}
+
+// a view of an entry: zero copy (inside the archive mapping) or inflated in its own buffer
+struct ZipIo::Stream {
+    const Entry *entry = nullptr;
+#ifdef C2D_ZIP_INFLATE
+    z_stream zs{};
+#endif
+    uint64_t consumed = 0;  // compressed bytes fed to the stream
+    uint64_t produced = 0;  // bytes inflated so far
+    uint32_t crc = 0;       // of the bytes inflated so far
+    // compressed input, when the archive isn't mapped
+    std::vector<uint8_t> input;
+};
+
+class ZipMap : public Io::Map {
+public:
+    ZipMap(std::shared_ptr<Io::Map> archive, const uint8_t *data, size_t size) {
+        m_archive = std::move(archive);
+        m_data = data;
+        m_size = size;
+        m_mapped = true;
+    }
+
+    ZipMap(uint8_t *buffer, size_t size) {
+        m_buffer = buffer;
+        m_data = buffer;
+        m_size = size;
+    }
+
+private:
+    std::shared_ptr<Io::Map> m_archive;
+};
+
+ZipIo::ZipIo(Io *io, const std::string &archive, const std::string &mountPoint) : Io() {
+    m_io = io;
+    m_archive = archive;
+    m_mount = Utility::removeLastSlash(mountPoint.empty() ? archive : mountPoint);
+    m_mutex = new C2DMutex();
+    m_open = open();
+    if (m_open) {
+        printf("ZipIo: %s mounted on %s (%zu entries)\n", m_archive.c_str(), m_mount.c_str(), m_entries.size());
+    }
+}
+
+Io *ZipIo::getIo() {
+    return m_io;
+}
+
+bool ZipIo::isOpen() {
+    return m_open;
+}
+
+std::string ZipIo::getMountPoint() {
+    return m_mount;
+}
+
+size_t ZipIo::getEntryCount() {
+    return m_entries.size();
+}
+
+bool ZipIo::readAt(uint64_t offset, void *dst, size_t size) {
+    if (size == 0) {
+        return true;
+    }
+    if (offset + size > m_archive_size) {
+        return false;
+    }
+
+    if (m_map) {
+        memcpy(dst, m_map->getData() + offset, size);
+        return true;
+    }
+
+    if (m_file) {
+        m_mutex->lock();
+#ifdef __WINDOWS__
+        bool ok = _fseeki64(m_file, (int64_t) offset, SEEK_SET) == 0;
+#elif defined(__LINUX__) || defined(__ANDROID__) || defined(__APPLE__)
+        bool ok = fseeko(m_file, (off_t) offset, SEEK_SET) == 0;
+#else
+        bool ok = fseek(m_file, (long) offset, SEEK_SET) == 0;
+#endif
+        ok = ok && fread(dst, 1, size, m_file) == size;
+        m_mutex->unlock();
+        return ok;
+    }
+
+    return m_io->read(m_archive, (char *) dst, size, (size_t) offset) == size;
+}
+
+bool ZipIo::open() {
+    m_archive_size = m_io->getSize(m_archive);
+    if (m_archive_size < 22) {
+        printf("ZipIo: could not open %s\n", m_archive.c_str());
+        return false;
+    }
+
+#ifdef C2D_ZIP_MMAP
+    Io::Map *map = m_io->map(m_archive, Advice::Random);
+    if (map && map->isMapped()) {
+        m_map.reset(map);
+        m_archive_size = map->getSize();
+    } else {
+        delete (map);
+    }
+#endif
+    if (!m_map) {
+        // one handle for all the reads, instead of an open per Io::read. Archives which aren't
+        // on the filesystem (inside another ZipIo...) are still read through the io
+        m_file = fopen(m_archive.c_str(), "rb");
+    }
+
+    // end of central directory record, followed by a comment of up to 64 KB
+    size_t tailSize = (size_t) std::min<uint64_t>(m_archive_size, 22 + 65535);
+    std::vector<uint8_t> tail(tailSize);
+    if (!readAt(m_archive_size - tailSize, tail.data(), tailSize)) {
+        return false;
+    }
+
+    long end = -1;
+    for (long i = (long) tailSize - 22; i >= 0; i--) {
+        if (rd32(&tail[i]) == ZIP_END_SIG) {
+            end = i;
+            break;
+        }
+    }
+    if (end < 0) {
+        printf("ZipIo: %s is not a zip archive\n", m_archive.c_str());
+        return false;
+    }
+
+    uint64_t count = rd16(&tail[end + 10]);
+    uint64_t cdSize = rd32(&tail[end + 12]);
+    uint64_t cdOffset = rd32(&tail[end + 16]);
+
+    // zip64: the real values are in the zip64 end record, found through its locator
+    uint64_t endOffset = m_archive_size - tailSize + end;
+    if ((count == 0xFFFF || cdSize == 0xFFFFFFFF || cdOffset == 0xFFFFFFFF) && endOffset >= 20) {
+        uint8_t locator[20], end64[56];
+        if (readAt(endOffset - 20, locator, 20) && rd32(locator) == ZIP64_LOCATOR_SIG
+            && readAt(rd64(locator + 8), end64, 56) && rd32(end64) == ZIP64_END_SIG) {
+            count = rd64(end64 + 32);
+            cdSize = rd64(end64 + 40);
+            cdOffset = rd64(end64 + 48);
+        }
+    }
+
+    if (cdOffset + cdSize > m_archive_size) {
+        printf("ZipIo: %s central directory is truncated\n", m_archive.c_str());
+        return false;
+    }
+
+    std::vector<uint8_t> buffer;
+    const uint8_t *cd;
+    if (m_map) {
+        cd = m_map->getData() + cdOffset;
+    } else {
+        buffer.resize((size_t) cdSize);
+        if (!readAt(cdOffset, buffer.data(), (size_t) cdSize)) {
+            return false;
+        }
+        cd = buffer.data();
+    }
+
+    m_entries.reserve((size_t) count + 16);
+    m_index.reserve((size_t) count + 16);
+    addDirectory("");
+
+    const uint8_t *p = cd;
+    const uint8_t *cdEnd = cd + cdSize;
+    for (uint64_t i = 0; i < count; i++) {
+        if (p + 46 > cdEnd || rd32(p) != ZIP_CENTRAL_HEADER_SIG) {
+            printf("ZipIo: %s central directory is corrupted\n", m_archive.c_str());
+            return false;
+        }
+
+        uint16_t nameLen = rd16(p + 28), extraLen = rd16(p + 30), commentLen = rd16(p + 32);
+        if (p + 46 + nameLen + extraLen + commentLen > cdEnd) {
+            return false;
+        }
+
+        Entry entry;
+        entry.method = rd16(p + 10);
+        entry.time = rd16(p + 12);
+        entry.date = rd16(p + 14);
+        entry.crc = rd32(p + 16);
+        entry.compressedSize = rd32(p + 20);
+        entry.size = rd32(p + 24);
+        entry.offset = rd32(p + 42);
+
+        // zip64 extended information, only the fields saturated in the header are present
+        const uint8_t *extra = p + 46 + nameLen;
+        for (const uint8_t *e = extra; e + 4 <= extra + extraLen;) {
+            uint16_t id = rd16(e), len = rd16(e + 2);
+            if (id == 0x0001) {
+                const uint8_t *v = e + 4, *vEnd = e + 4 + len;
+                if (entry.size == 0xFFFFFFFF && v + 8 <= vEnd) {
+                    entry.size = rd64(v);
+                    v += 8;
+                }
+                if (entry.compressedSize == 0xFFFFFFFF && v + 8 <= vEnd) {
+                    entry.compressedSize = rd64(v);
+                    v += 8;
+                }
+                if (entry.offset == 0xFFFFFFFF && v + 8 <= vEnd) {
+                    entry.offset = rd64(v);
+                }
+                break;
+            }
+            e += 4 + len;
+        }
+
+        std::string path((const char *) p + 46, nameLen);
+        p += 46 + nameLen + extraLen + commentLen;
+
+        while (!path.empty() && path[0] == '/') {
+            path.erase(0, 1);
+        }
+        if (!path.empty() && path.back() == '/') {
+            path.pop_back();
+            entry.directory = true;
+        }
+        if (path.empty() || path == "." || path == ".." || path.compare(0, 3, "../") == 0
+            || path.find("/../") != std::string::npos) {
+            continue;
+        }
+
+        addEntry(path, entry);
+    }
+
+    return true;
+}
+
+size_t ZipIo::addDirectory(const std::string &path) {
+    auto it = m_index.find(path);
+    if (it != m_index.end()) {
+        return it->second;
+    }
+
+    Entry entry;
+    entry.directory = true;
+    size_t pos = path.find_last_of('/');
+    entry.name = pos == std::string::npos ? path : path.substr(pos + 1);
+
+    size_t index = m_entries.size();
+    m_entries.push_back(entry);
+    m_index[path] = index;
+    m_children[path];
+    if (!path.empty()) {
+        addDirectory(pos == std::string::npos ? "" : path.substr(0, pos));
+        m_children[pos == std::string::npos ? "" : path.substr(0, pos)].push_back(index);
+    }
+
+    return index;
+}
+
+void ZipIo::addEntry(const std::string &path, const Entry &entry) {
+    if (entry.directory) {
+        addDirectory(path);
+        return;
+    }
+
+    if (m_index.find(path) != m_index.end()) {
+        // duplicated name, the first one wins
+        return;
+    }
+
+    size_t pos = path.find_last_of('/');
+    std::string parent = pos == std::string::npos ? "" : path.substr(0, pos);
+    addDirectory(parent);
+
+    size_t index = m_entries.size();
+    m_entries.push_back(entry);
+    m_entries.back().name = pos == std::string::npos ? path : path.substr(pos + 1);
+    m_index[path] = index;
+    m_children[parent].push_back(index);
+}
+
+bool ZipIo::getInnerPath(const std::string &path, std::string *inner) {
+    if (!m_open || path.compare(0, m_mount.length(), m_mount) != 0) {
+        return false;
+    }
+
+    if (path.length() == m_mount.length()) {
+        inner->clear();
+        return true;
+    }
+    if (path[m_mount.length()] != '/') {
+        return false;
+    }
+
+    *inner = Utility::removeLastSlash(path.substr(m_mount.length() + 1));
+    // not in the archive: forwarded, so an archive mounted over a directory overlays it
+    return m_index.find(*inner) != m_index.end();
+}
+
+const ZipIo::Entry *ZipIo::find(const std::string &inner) {
+    auto it = m_index.find(inner);
+    return it == m_index.end() ? nullptr : &m_entries[it->second];
+}
+
+Io::File ZipIo::toFile(const std::string &inner, const Entry &entry) {
+    return {entry.name, inner.empty() ? m_mount : m_mount + "/" + inner,
+            entry.directory ? Type::Directory : Type::File, (size_t) entry.size};
+}
+
+bool ZipIo::getDataOffset(const Entry &entry, uint64_t *offset) {
+    // the local header extra field may differ from the central one
+    uint8_t header[30];
+    if (!readAt(entry.offset, header, 30) || rd32(header) != ZIP_LOCAL_HEADER_SIG) {
+        return false;
+    }
+
+    *offset = entry.offset + 30 + rd16(header + 26) + rd16(header + 28);
+    return *offset + entry.compressedSize <= m_archive_size;
+}
+
+size_t ZipIo::extract(const Entry &entry, uint8_t *out, size_t size, uint64_t offset) {
+    uint64_t data;
+    if (!getDataOffset(entry, &data)) {
+        printf("ZipIo: %s: corrupted entry %s\n", m_archive.c_str(), entry.name.c_str());
+        return -1;
+    }
+
+    if (offset >= entry.size) {
+        return 0;
+    }
+    size = (size_t) std::min<uint64_t>(size, entry.size - offset);
+
+    if (entry.method == ZIP_METHOD_STORED) {
+        return readAt(data + offset, out, size) ? size : -1;
+    }
+
+#ifdef C2D_ZIP_INFLATE
+    if (entry.method != ZIP_METHOD_DEFLATED) {
+        printf("ZipIo: %s: unsupported compression method %i\n", entry.name.c_str(), entry.method);
+        return -1;
+    }
+
+    // resume the stream left by a previous read of this entry, ending where this one starts
+    // (or before), so reading an entry by consecutive chunks inflates it once
+    Stream *stream = nullptr;
+    m_mutex->lock();
+    for (auto it = m_streams.begin(); it != m_streams.end(); ++it) {
+        if ((*it)->entry == &entry && (*it)->produced <= offset) {
+            stream = *it;
+            m_streams.erase(it);
+            break;
+        }
+    }
+    m_mutex->unlock();
+
+    if (!stream) {
+        stream = new Stream();
+        stream->entry = &entry;
+        stream->crc = crc32(0, nullptr, 0);
+        if (inflateInit2(&stream->zs, -MAX_WBITS) != Z_OK) {
+            delete (stream);
+            return -1;
+        }
+        // compressed input straight from the mapping, or read by chunks
+        if (!m_map) {
+            stream->input.resize(ZIP_READ_CHUNK);
+        }
+    }
+
+    z_stream &zs = stream->zs;
+    // decompressed data before "offset" is inflated here and dropped
+    std::vector<uint8_t> skip(stream->produced < offset ? ZIP_READ_CHUNK : 0);
+    uint64_t end = offset + size;
+    bool failed = false;
+
+    while (stream->produced < end) {
+        if (zs.avail_in == 0) {
+            uint64_t left = entry.compressedSize - stream->consumed;
+            if (left == 0) {
+                failed = true;
+                break;
+            }
+            auto chunk = (uInt) std::min<uint64_t>(left, m_map ? 0x40000000 : ZIP_READ_CHUNK);
+            if (m_map) {
+                zs.next_in = (Bytef *) m_map->getData() + data + stream->consumed;
+            } else if (readAt(data + stream->consumed, stream->input.data(), chunk)) {
+                zs.next_in = stream->input.data();
+            } else {
+                failed = true;
+                break;
+            }
+            zs.avail_in = chunk;
+            stream->consumed += chunk;
+        }
+
+        uint8_t *dst;
+        if (stream->produced < offset) {
+            dst = skip.data();
+            zs.avail_out = (uInt) std::min<uint64_t>(offset - stream->produced, skip.size());
+        } else {
+            dst = out + (stream->produced - offset);
+            zs.avail_out = (uInt) std::min<uint64_t>(end - stream->produced, 0x40000000);
+        }
+        zs.next_out = dst;
+
+        int ret = inflate(&zs, Z_NO_FLUSH);
+        size_t written = zs.next_out - dst;
+        stream->crc = crc32(stream->crc, dst, (uInt) written);
+        stream->produced += written;
+        if (ret == Z_STREAM_END) {
+            break;
+        }
+        if (ret != Z_OK && !(ret == Z_BUF_ERROR && written > 0)) {
+            failed = true;
+            break;
+        }
+    }
+
+    if (failed || stream->produced < end) {
+        closeStream(stream);
+        printf("ZipIo: %s: could not inflate %s\n", m_archive.c_str(), entry.name.c_str());
+        return -1;
+    }
+
+    // the whole entry went through this stream, it can be checked
+    if (stream->produced == entry.size) {
+        bool valid = stream->crc == entry.crc;
+        closeStream(stream);
+        if (!valid) {
+            printf("ZipIo: %s: crc mismatch for %s\n", m_archive.c_str(), entry.name.c_str());
+            return -1;
+        }
+        return size;
+    }
+
+    m_mutex->lock();
+    m_streams.insert(m_streams.begin(), stream);
+    if (m_streams.size() > ZIP_STREAMS_MAX) {
+        closeStream(m_streams.back());
+        m_streams.pop_back();
+    }
+    m_mutex->unlock();
+
+    return size;
+#else
+    printf("ZipIo: %s: compressed entries are not supported on this platform\n", entry.name.c_str());
+    return -1;
+#endif
+}
+
+void ZipIo::closeStream(Stream *stream) {
+#ifdef C2D_ZIP_INFLATE
+    inflateEnd(&stream->zs);
+#endif
+    delete (stream);
+}
+
+Io::File ZipIo::getFile(const std::string &path) {
+    std::string inner;
+    if (!getInnerPath(path, &inner)) {
+        return m_io->getFile(path);
+    }
+
+    const Entry *entry = find(inner);
+    return entry ? toFile(inner, *entry) : File{};
+}
+
+bool ZipIo::exist(const std::string &path) {
+    std::string inner;
+    if (!getInnerPath(path, &inner)) {
+        return m_io->exist(path);
+    }
+
+    return find(inner) != nullptr;
+}
+
+size_t ZipIo::getSize(const std::string &file) {
+    std::string inner;
+    if (!getInnerPath(file, &inner)) {
+        return m_io->getSize(file);
+    }
+
+    const Entry *entry = find(inner);
+    return entry && !entry->directory ? (size_t) entry->size : 0;
+}
+
+Io::Type ZipIo::getType(const std::string &file) {
+    std::string inner;
+    if (!getInnerPath(file, &inner)) {
+        return m_io->getType(file);
+    }
+
+    const Entry *entry = find(inner);
+    return entry ? (entry->directory ? Type::Directory : Type::File) : Type::Unknown;
+}
+
+int64_t ZipIo::getModificationTime(const std::string &path) {
+    std::string inner;
+    if (!getInnerPath(path, &inner)) {
+        return m_io->getModificationTime(path);
+    }
+
+    const Entry *entry = find(inner);
+    if (!entry || entry->date == 0) {
+        // root and implied directories
+        return entry ? m_io->getModificationTime(m_archive) : -1;
+    }
+
+    struct tm tm{};
+    tm.tm_year = ((entry->date >> 9) & 0x7F) + 80;
+    tm.tm_mon = ((entry->date >> 5) & 0x0F) - 1;
+    tm.tm_mday = entry->date & 0x1F;
+    tm.tm_hour = (entry->time >> 11) & 0x1F;
+    tm.tm_min = (entry->time >> 5) & 0x3F;
+    tm.tm_sec = (entry->time & 0x1F) * 2;
+    tm.tm_isdst = -1;
+
+    return (int64_t) mktime(&tm) * 1000000000;
+}
+
+std::vector<Io::File> ZipIo::getDirList(const std::string &path, bool sort, bool showHidden) {
+    std::string inner;
+    if (!getInnerPath(path, &inner)) {
+        return m_io->getDirList(path, sort, showHidden);
+    }
+
+    std::vector<File> files;
+    auto it = m_children.find(inner);
+    if (it == m_children.end()) {
+        return files;
+    }
+
+    files.reserve(it->second.size());
+    std::string base = inner.empty() ? "" : inner + "/";
+    for (size_t index: it->second) {
+        const Entry &entry = m_entries[index];
+        if (!showHidden && entry.name[0] == '.') {
+            continue;
+        }
+        files.push_back(toFile(base + entry.name, entry));
+    }
+
+    if (sort) {
+        std::sort(files.begin(), files.end(), compare);
+    }
+
+    return files;
+}
+
+std::vector<Io::File> ZipIo::findFiles(const std::string &path, const std::vector<std::string> &whitelist,
+                                       const std::string &blacklist, bool stopOnFirst) {
+    std::string inner;
+    if (!getInnerPath(path, &inner)) {
+        return m_io->findFiles(path, whitelist, blacklist, stopOnFirst);
+    }
+
+    std::vector<File> files;
+    auto it = m_children.find(inner);
+    if (it == m_children.end()) {
+        return files;
+    }
+
+    std::string base = inner.empty() ? "" : inner + "/";
+    for (size_t index: it->second) {
+        const Entry &entry = m_entries[index];
+        for (const auto &search: whitelist) {
+            if (Utility::contains(entry.name, search)) {
+                if (!blacklist.empty() && Utility::contains(entry.name, blacklist)) {
+                    continue;
+                }
+                files.push_back(toFile(base + entry.name, entry));
+                if (stopOnFirst) break;
+            }
+        }
+    }
+
+    return files;
+}
+
+size_t ZipIo::findFilesRecursive(const std::string &path, const std::vector<std::string> &extensions,
+                                 const std::function<bool(const File &file)> &callback,
+                                 const std::string &blacklist) {
+    std::string inner;
+    if (!getInnerPath(path, &inner)) {
+        return m_io->findFilesRecursive(path, extensions, callback, blacklist);
+    }
+
+    // listings come from the index, walking them doesn't need threads
+    return Io::findFilesRecursive(path, extensions, callback, blacklist);
+}
+
+size_t ZipIo::read(const std::string &file, char *out, size_t size, size_t offset) {
+    std::string inner;
+    if (!getInnerPath(file, &inner)) {
+        return m_io->read(file, out, size, offset);
+    }
+
+    const Entry *entry = find(inner);
+    if (!entry || entry->directory) {
+        printf("ZipIo::read: can't open %s\n", file.c_str());
+        return -1;
+    }
+
+    if (size == 0) {
+        size = (size_t) entry->size;
+    }
+
+    return extract(*entry, (uint8_t *) out, size, offset);
+}
+
+Io::Map *ZipIo::map(const std::string &file, Advice advice) {
+    std::string inner;
+    if (!getInnerPath(file, &inner)) {
+        return m_io->map(file, advice);
+    }
+
+    const Entry *entry = find(inner);
+    if (!entry || entry->directory || entry->size == 0) {
+        return nullptr;
+    }
+
+    uint64_t data;
+    if (m_map && entry->method == ZIP_METHOD_STORED && getDataOffset(*entry, &data)) {
+        return new ZipMap(m_map, m_map->getData() + data, (size_t) entry->size);
+    }
+
+    auto buffer = new uint8_t[entry->size];
+    if (extract(*entry, buffer, (size_t) entry->size, 0) != entry->size) {
+        delete[] buffer;
+        return nullptr;
+    }
+
+    return new ZipMap(buffer, (size_t) entry->size);
+}
+
+bool ZipIo::isMappable(const std::string &file) {
+    std::string inner;
+    if (!getInnerPath(file, &inner)) {
+        return m_io->isMappable(file);
+    }
+
+    // only stored entries are views of the archive mapping, deflated ones are inflated by map
+    const Entry *entry = find(inner);
+    return m_map && entry && !entry->directory && entry->method == ZIP_METHOD_STORED;
+}
+
+bool ZipIo::copyEntry(const std::string &inner, const std::string &dst,
+                      const std::function<void(File, File, float)> &callback) {
+    const Entry *entry = find(inner);
+    if (!entry) {
+        return false;
+    }
+
+    File src = toFile(inner, *entry);
+    File out = src;
+    out.path = Utility::removeLastSlash(dst) + "/" + entry->name;
+
+    if (entry->directory) {
+        if (!m_io->create(out.path)) {
+            return false;
+        }
+        std::string base = inner.empty() ? "" : inner + "/";
+        for (size_t index: m_children.at(inner)) {
+            if (!copyEntry(base + m_entries[index].name, out.path, callback)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    if (callback != nullptr) {
+        callback(src, out, 0);
+    }
+
+    Map *view = map(src.path);
+    bool res = view ? m_io->write(out.path, (const char *) view->getData(), view->getSize())
+                    : entry->size == 0 && m_io->write(out.path, "", 0);
+    delete (view);
+
+    if (callback != nullptr) {
+        callback(src, out, res ? 1 : -1);
+    }
+
+    return res;
+}
+
+bool ZipIo::copy(const std::string &src, const std::string &dst,
+                 const std::function<void(File, File, float)> &callback) {
+    std::string inner, innerDst;
+    if (getInnerPath(dst, &innerDst)) {
+        // read only
+        if (callback != nullptr) {
+            callback(File{}, File{}, -1);
+        }
+        return false;
+    }
+    if (!getInnerPath(src, &inner)) {
+        return m_io->copy(src, dst, callback);
+    }
+
+    bool res = copyEntry(inner, dst, callback);
+
+    if (callback != nullptr) {
+        callback(File{}, File{}, res ? 2 : -1);
+    }
+
+    return res;
+}
+
+bool ZipIo::create(const std::string &path) {
+    std::string inner;
+    return !getInnerPath(path, &inner) && m_io->create(path);
+}
+
+bool ZipIo::removeFile(const std::string &path) {
+    std::string inner;
+    return !getInnerPath(path, &inner) && m_io->removeFile(path);
+}
+
+bool ZipIo::removeDir(const std::string &path) {
+    std::string inner;
+    return !getInnerPath(path, &inner) && m_io->removeDir(path);
+}
+
+bool ZipIo::write(const std::string &file, const char *data, size_t size) {
+    std::string inner;
+    return !getInnerPath(file, &inner) && m_io->write(file, data, size);
+}
+
+std::string ZipIo::getRomFsPath() {
+    return m_io->getRomFsPath();
+}
+
+std::string ZipIo::getDataPath() {
+    return m_io->getDataPath();
+}
+
+void ZipIo::setDataPath(const std::string &path) {
+    m_io->setDataPath(path);
+}
+
+void ZipIo::setCopyThreads(int threads) {
+    m_io->setCopyThreads(threads);
+}
+
+int ZipIo::getCopyThreads() {
+    return m_io->getCopyThreads();
+}
+
+void ZipIo::setScanThreads(int threads) {
+    m_io->setScanThreads(threads);
+}
+
+int ZipIo::getScanThreads() {
+    return m_io->getScanThreads();
+}
+
+Io::CopyStats ZipIo::getCopyStats() {
+    return m_io->getCopyStats();
+}
+
+void ZipIo::resetCopyStats() {
+    m_io->resetCopyStats();
+}
+
+Io::ListStats ZipIo::getListStats() {
+    return m_io->getListStats();
+}
+
+void ZipIo::resetListStats() {
+    m_io->resetListStats();
+}
+
+void ZipIo::setDeferredStat(bool enable) {
+    m_io->setDeferredStat(enable);
+}
+
+bool ZipIo::getDeferredStat() {
+    return m_io->getDeferredStat();
+}
+
+bool ZipIo::resolve(File *file) {
+    std::string inner;
+    if (!getInnerPath(file->path, &inner)) {
+        return m_io->resolve(file);
+    }
+
+    // archive entries are always complete
+    return true;
+}
+
+ZipIo::~ZipIo() {
+    for (auto stream: m_streams) {
+        closeStream(stream);
+    }
+    delete (m_mutex);
+    if (m_file) {
+        fclose(m_file);
+    }
+    m_map.reset();
+    delete (m_io);
+}
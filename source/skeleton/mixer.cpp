@@ -0,0 +1,289 @@
+//
+// Created by cpasjuste on 17/10/2026.
+//
+
+#include "cross2d/c2d.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+using namespace c2d;
+
+// accumulate "frames" stereo frames into "acc", applying left/right gains
+static void mixStereo(float *acc, const int16_t *src, int frames, float left, float right) {
+    int i = 0, count = frames * 2;
+#if defined(__SSE2__)
+    __m128 gains = _mm_setr_ps(left, right, left, right);
+    for (; i + 8 <= count; i += 8) {
+        __m128i s = _mm_loadu_si128((const __m128i *) (src + i));
+        __m128 lo = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(s, s), 16));
+        __m128 hi = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(s, s), 16));
+        _mm_storeu_ps(acc + i, _mm_add_ps(_mm_loadu_ps(acc + i), _mm_mul_ps(lo, gains)));
+        _mm_storeu_ps(acc + i + 4, _mm_add_ps(_mm_loadu_ps(acc + i + 4), _mm_mul_ps(hi, gains)));
+    }
+#elif defined(__ARM_NEON)
+    const float g[4] = {left, right, left, right};
+    float32x4_t gains = vld1q_f32(g);
+    for (; i + 8 <= count; i += 8) {
+        int16x8_t s = vld1q_s16(src + i);
+        float32x4_t lo = vcvtq_f32_s32(vmovl_s16(vget_low_s16(s)));
+        float32x4_t hi = vcvtq_f32_s32(vmovl_s16(vget_high_s16(s)));
+        vst1q_f32(acc + i, vmlaq_f32(vld1q_f32(acc + i), lo, gains));
+        vst1q_f32(acc + i + 4, vmlaq_f32(vld1q_f32(acc + i + 4), hi, gains));
+    }
+#endif
+    for (; i < count; i += 2) {
+        acc[i] += (float) src[i] * left;
+        acc[i + 1] += (float) src[i + 1] * right;
+    }
+}
+
+// accumulate "frames" mono frames into the stereo "acc", applying left/right gains
+static void mixMono(float *acc, const int16_t *src, int frames, float left, float right) {
+    int i = 0;
+#if defined(__SSE2__)
+    __m128 gains = _mm_setr_ps(left, right, left, right);
+    for (; i + 4 <= frames; i += 4) {
+        __m128i s = _mm_loadl_epi64((const __m128i *) (src + i));
+        __m128 m = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(s, s), 16));
+        __m128 lo = _mm_unpacklo_ps(m, m);
+        __m128 hi = _mm_unpackhi_ps(m, m);
+        _mm_storeu_ps(acc + i * 2, _mm_add_ps(_mm_loadu_ps(acc + i * 2), _mm_mul_ps(lo, gains)));
+        _mm_storeu_ps(acc + i * 2 + 4, _mm_add_ps(_mm_loadu_ps(acc + i * 2 + 4), _mm_mul_ps(hi, gains)));
+    }
+#elif defined(__ARM_NEON)
+    const float g[4] = {left, right, left, right};
+    float32x4_t gains = vld1q_f32(g);
+    for (; i + 4 <= frames; i += 4) {
+        float32x4_t m = vcvtq_f32_s32(vmovl_s16(vld1_s16(src + i)));
+        float32x4x2_t d = vzipq_f32(m, m);
+        vst1q_f32(acc + i * 2, vmlaq_f32(vld1q_f32(acc + i * 2), d.val[0], gains));
+        vst1q_f32(acc + i * 2 + 4, vmlaq_f32(vld1q_f32(acc + i * 2 + 4), d.val[1], gains));
+    }
+#endif
+    for (; i < frames; i++) {
+        acc[i * 2] += (float) src[i] * left;
+        acc[i * 2 + 1] += (float) src[i] * right;
+    }
+}
+
+// convert the accumulator back to S16, with saturation
+static void toS16(const float *acc, int16_t *dst, int count, float gain) {
+    int i = 0;
+#if defined(__SSE2__)
+    __m128 g = _mm_set1_ps(gain);
+    for (; i + 8 <= count; i += 8) {
+        __m128i lo = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(acc + i), g));
+        __m128i hi = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(acc + i + 4), g));
+        _mm_storeu_si128((__m128i *) (dst + i), _mm_packs_epi32(lo, hi));
+    }
+#elif defined(__ARM_NEON)
+    for (; i + 8 <= count; i += 8) {
+        int32x4_t lo = vcvtq_s32_f32(vmulq_n_f32(vld1q_f32(acc + i), gain));
+        int32x4_t hi = vcvtq_s32_f32(vmulq_n_f32(vld1q_f32(acc + i + 4), gain));
+        vst1q_s16(dst + i, vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi)));
+    }
+#endif
+    for (; i < count; i++) {
+        float v = acc[i] * gain;
+        dst[i] = (int16_t) (v > 32767.0f ? 32767 : (v < -32768.0f ? -32768 : (int) v));
+    }
+}
+
+Mixer::Mixer(int voices, int maxFrames) : m_voices((size_t) voices) {
+    m_max_frames = maxFrames;
+    m_accum.resize((size_t) maxFrames * 2);
+    m_scratch.resize((size_t) maxFrames * 2);
+}
+
+Mixer::~Mixer() {
+    for (auto &voice: m_voices) {
+        delete (voice.stream);
+    }
+}
+
+Mixer::Voice *Mixer::acquire() {
+    for (auto &voice: m_voices) {
+        int state = Free;
+        if (voice.state.compare_exchange_strong(state, Setup)) {
+            // the audio thread is done with this slot, we can (re)configure it
+            delete (voice.stream);
+            voice.stream = nullptr;
+            voice.samples = nullptr;
+            voice.frames = 0;
+            voice.position = 0;
+            voice.loop = false;
+            return &voice;
+        }
+    }
+
+    return nullptr;
+}
+
+int Mixer::play(const int16_t *samples, int frames, int channels, float gain, float pan, bool loop) {
+    if (!samples || frames <= 0 || channels < 1 || channels > 2) {
+        return -1;
+    }
+
+    Voice *voice = acquire();
+    if (!voice) {
+        printf("Mixer::play: no voice available\n");
+        return -1;
+    }
+
+    voice->samples = samples;
+    voice->frames = frames;
+    voice->channels = channels;
+    voice->loop = loop;
+    voice->gain.store(gain);
+    voice->pan.store(pan);
+    voice->state.store(Playing, std::memory_order_release);
+
+    return (int) (voice - m_voices.data());
+}
+
+int Mixer::openStream(int capacity, int channels, float gain, float pan) {
+    if (capacity <= 0 || channels < 1 || channels > 2) {
+        return -1;
+    }
+
+    Voice *voice = acquire();
+    if (!voice) {
+        printf("Mixer::openStream: no voice available\n");
+        return -1;
+    }
+
+    voice->stream = new SampleBuffer(capacity * channels);
+    voice->channels = channels;
+    voice->gain.store(gain);
+    voice->pan.store(pan);
+    voice->state.store(Playing, std::memory_order_release);
+
+    return (int) (voice - m_voices.data());
+}
+
+bool Mixer::push(int voice, const int16_t *samples, int frames) {
+    if (voice < 0 || voice >= (int) m_voices.size()) {
+        return false;
+    }
+
+    Voice &v = m_voices[voice];
+    if (v.state.load(std::memory_order_acquire) != Playing || !v.stream) {
+        return false;
+    }
+
+    return v.stream->push(const_cast<int16_t *>(samples), frames * v.channels);
+}
+
+void Mixer::stop(int voice) {
+    if (voice < 0 || voice >= (int) m_voices.size()) {
+        return;
+    }
+
+    int state = Playing;
+    m_voices[voice].state.compare_exchange_strong(state, Stopping);
+}
+
+void Mixer::stopAll() {
+    for (size_t i = 0; i < m_voices.size(); i++) {
+        stop((int) i);
+    }
+}
+
+bool Mixer::isPlaying(int voice) {
+    if (voice < 0 || voice >= (int) m_voices.size()) {
+        return false;
+    }
+
+    return m_voices[voice].state.load() == Playing;
+}
+
+void Mixer::setGain(int voice, float gain) {
+    if (voice >= 0 && voice < (int) m_voices.size()) {
+        m_voices[voice].gain.store(gain);
+    }
+}
+
+void Mixer::setPan(int voice, float pan) {
+    if (voice >= 0 && voice < (int) m_voices.size()) {
+        m_voices[voice].pan.store(pan < -1.0f ? -1.0f : (pan > 1.0f ? 1.0f : pan));
+    }
+}
+
+void Mixer::setMasterGain(float gain) {
+    m_master.store(gain);
+}
+
+void Mixer::mix(int16_t *out, int frames) {
+    while (frames > 0) {
+        int count = frames < m_max_frames ? frames : m_max_frames;
+        mixChunk(out, count);
+        out += count * 2;
+        frames -= count;
+    }
+}
+
+void Mixer::mixChunk(int16_t *out, int frames) {
+    // start from the Audio::play stream
+    float *acc = m_accum.data();
+    for (int i = 0; i < frames * 2; i++) {
+        acc[i] = (float) out[i];
+    }
+
+    for (auto &voice: m_voices) {
+        int state = voice.state.load(std::memory_order_acquire);
+        if (state == Stopping) {
+            voice.state.store(Free, std::memory_order_release);
+            continue;
+        }
+        if (state != Playing) {
+            continue;
+        }
+
+        float gain = voice.gain.load(std::memory_order_relaxed);
+        float pan = voice.pan.load(std::memory_order_relaxed);
+        float left = gain * (pan > 0 ? 1.0f - pan : 1.0f);
+        float right = gain * (pan < 0 ? 1.0f + pan : 1.0f);
+
+        if (voice.stream) {
+            // stream: mix what's available, an underrun is just silence
+            int available = voice.stream->space_readable() / voice.channels;
+            int count = available < frames ? available : frames;
+            if (count > 0 && voice.stream->pull(m_scratch.data(), count * voice.channels)) {
+                if (voice.channels == 2) {
+                    mixStereo(acc, m_scratch.data(), count, left, right);
+                } else {
+                    mixMono(acc, m_scratch.data(), count, left, right);
+                }
+            }
+            continue;
+        }
+
+        // one-shot: mix the remaining part, wrapping if looping
+        int done = 0;
+        while (done < frames) {
+            int count = voice.frames - voice.position;
+            if (count > frames - done) count = frames - done;
+            const int16_t *src = voice.samples + voice.position * voice.channels;
+            if (voice.channels == 2) {
+                mixStereo(acc + done * 2, src, count, left, right);
+            } else {
+                mixMono(acc + done * 2, src, count, left, right);
+            }
+            done += count;
+            voice.position += count;
+            if (voice.position >= voice.frames) {
+                if (!voice.loop) {
+                    voice.state.store(Free, std::memory_order_release);
+                    break;
+                }
+                voice.position = 0;
+            }
+        }
+    }
+
+    toS16(acc, out, frames * 2, m_master.load(std::memory_order_relaxed));
+}
@@ -23,8 +23,16 @@ Renderer::Renderer(const Vector2f &size) : Rectangle(size) {
     // set static access to renderer (TODO: handle this in a smarter way)
     c2d_renderer = this;
 
-    m_input = new C2DInput();
+    m_input = Input::create();
     m_io = new C2DIo();
+#if defined(__WINDOWS__) || defined(__LINUX__)
+    // packed romfs (tools/romfs_pack.cpp), served from its index instead of the data_romfs files
+    std::string romfs = m_io->getRomFsPath();
+    std::string pack = Utility::removeLastSlash(romfs) + ".pak";
+    if (m_io->getType(pack) == Io::Type::File) {
+        m_io = new ZipIo(m_io, pack, romfs);
+    }
+#endif
     m_font = new C2DFont();
     m_font->loadDefault();
     m_elapsedClock = new C2DClock();
@@ -33,6 +41,12 @@ Renderer::Renderer(const Vector2f &size) : Rectangle(size) {
 }
 
 void Renderer::onUpdate() {
+    // io completions first, so their results are visible in this frame.
+    // Done here as some backends (psp2, 3ds) don't go through Renderer::flip
+    if (m_async_io) {
+        m_async_io->dispatch();
+    }
+
     // time
     m_deltaTime = m_deltaClock->restart();
 
@@ -42,14 +56,29 @@ void Renderer::onUpdate() {
         m_fpsClock->restart();
         m_frames = 0;
         if (m_stats_print) {
-            printf("fps: %f\n", m_fps);
+            if (m_latency_enabled && m_latency.events > 0) {
+                printf("fps: %f, input latency: %.1f ms avg, %.1f ms max\n",
+                       m_fps, m_latency.avgMs, m_latency.maxMs);
+            } else {
+                printf("fps: %f\n", m_fps);
+            }
         }
     }
     m_frames++;
+    m_frame++;
 
     // input
     if (m_process_inputs) {
         auto players = m_input->update();
+        if (m_latency_enabled) {
+            // backends without onPresented support never consume them
+            if (m_latency_pending.size() > 1024) {
+                m_latency_pending.clear();
+            }
+            for (const auto &event: m_input->getEvents()) {
+                m_latency_pending.push_back({event.time, m_frame});
+            }
+        }
         for (int i = 0; i < PLAYER_MAX; i++) {
             unsigned int buttons = players[i].buttons;
             if (buttons > 0 && buttons != Input::Button::Delay) {
@@ -74,6 +103,51 @@ void Renderer::flip(bool draw, bool inputs) {
     }
 }
 
+void Renderer::onPresented() {
+    if (!m_latency_enabled || m_latency_pending.empty()) {
+        return;
+    }
+
+    int64_t now = Input::getTime();
+    for (const auto &pending: m_latency_pending) {
+        float ms = (float) (now - pending.time) / 1000.0f;
+        if (ms < 0) ms = 0;
+        if (m_latency.events == 0 || ms < m_latency.minMs) m_latency.minMs = ms;
+        if (ms > m_latency.maxMs) m_latency.maxMs = ms;
+        m_latency_sum_us += ms * 1000.0;
+        m_latency_sum_frames += m_frame - pending.frame;
+        m_latency.events++;
+        int bucket = (int) (ms / 2);
+        m_latency.histogram[bucket < LatencyHistogramSize ? bucket : LatencyHistogramSize - 1]++;
+    }
+    m_latency.avgMs = (float) (m_latency_sum_us / 1000.0 / m_latency.events);
+    m_latency.avgFrames = (float) (m_latency_sum_frames / m_latency.events);
+    m_latency_pending.clear();
+}
+
+void Renderer::setLatencyStats(bool enable) {
+    m_latency_enabled = enable;
+    m_latency_pending.clear();
+}
+
+Renderer::LatencyStats Renderer::getLatencyStats() {
+    return m_latency;
+}
+
+void Renderer::resetLatencyStats() {
+    m_latency = LatencyStats();
+    m_latency_sum_us = 0;
+    m_latency_sum_frames = 0;
+    m_latency_pending.clear();
+}
+
+AsyncIo *Renderer::getAsyncIo() {
+    if (!m_async_io) {
+        m_async_io = new AsyncIo(m_io);
+    }
+    return m_async_io;
+}
+
 void Renderer::setClearColor(const Color &color) {
     m_clearColor = color;
 }
@@ -106,6 +180,7 @@ Renderer::~Renderer() {
     printf("~Renderer(%p)\n", this);
 
     delete (m_font);
+    delete (m_async_io);
     delete (m_io);
     delete (m_input);
 
@@ -0,0 +1,282 @@
+//
+// Created by cpasjuste on 17/10/2026.
+//
+
+#include <cmath>
+#include <chrono>
+#include "cross2d/c2d.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+using namespace c2d;
+
+static const int SincTaps = 32;
+static const int SincPhases = 256;
+
+static float dot(const float *a, const float *b, int n) {
+    int i = 0;
+    float sum = 0;
+#if defined(__SSE2__)
+    __m128 acc0 = _mm_setzero_ps(), acc1 = _mm_setzero_ps();
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+    }
+    acc0 = _mm_add_ps(acc0, acc1);
+    acc0 = _mm_add_ps(acc0, _mm_movehl_ps(acc0, acc0));
+    acc0 = _mm_add_ss(acc0, _mm_shuffle_ps(acc0, acc0, 1));
+    sum = _mm_cvtss_f32(acc0);
+#elif defined(__ARM_NEON)
+    float32x4_t acc0 = vdupq_n_f32(0), acc1 = vdupq_n_f32(0);
+    for (; i + 8 <= n; i += 8) {
+        acc0 = vmlaq_f32(acc0, vld1q_f32(a + i), vld1q_f32(b + i));
+        acc1 = vmlaq_f32(acc1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+    }
+    acc0 = vaddq_f32(acc0, acc1);
+    float32x2_t s = vadd_f32(vget_low_f32(acc0), vget_high_f32(acc0));
+    sum = vget_lane_f32(vpadd_f32(s, s), 0);
+#endif
+    for (; i < n; i++) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+// out = a + (b - a) * f
+static void lerp(const float *a, const float *b, float f, float *out, int n) {
+    int i = 0;
+#if defined(__SSE2__)
+    __m128 vf = _mm_set1_ps(f);
+    for (; i + 4 <= n; i += 4) {
+        __m128 va = _mm_loadu_ps(a + i);
+        _mm_storeu_ps(out + i, _mm_add_ps(va, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(b + i), va), vf)));
+    }
+#elif defined(__ARM_NEON)
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t va = vld1q_f32(a + i);
+        vst1q_f32(out + i, vmlaq_n_f32(va, vsubq_f32(vld1q_f32(b + i), va), f));
+    }
+#endif
+    for (; i < n; i++) {
+        out[i] = a[i] + (b[i] - a[i]) * f;
+    }
+}
+
+static inline int16_t toS16(float v) {
+    if (v >= 32767.0f) return 32767;
+    if (v <= -32768.0f) return -32768;
+    return (int16_t) (v >= 0 ? v + 0.5f : v - 0.5f);
+}
+
+Resampler::Resampler(int inputRate, int outputRate, int channels, Quality quality) {
+    m_input_rate = inputRate;
+    m_output_rate = outputRate;
+    m_channels = channels;
+    m_quality = quality;
+    m_history.resize((size_t) channels);
+
+    buildTable();
+    reset();
+}
+
+int Resampler::taps() {
+    return m_quality == Linear ? 2 : m_quality == Cubic ? 4 : SincTaps;
+}
+
+void Resampler::buildTable() {
+    if (m_quality != Sinc) {
+        m_table.clear();
+        return;
+    }
+
+    // low-pass at the lowest nyquist frequency, with some room for the transition band
+    double cutoff = (m_output_rate < m_input_rate ? (double) m_output_rate / m_input_rate : 1.0) * 0.95;
+    int half = SincTaps / 2;
+
+    m_table.resize((size_t) (SincPhases + 1) * SincTaps);
+    m_coefs.resize(SincTaps);
+    for (int p = 0; p <= SincPhases; p++) {
+        float *row = m_table.data() + p * SincTaps;
+        double sum = 0;
+        for (int k = 0; k < SincTaps; k++) {
+            // distance from the output position to input frame "i - half + 1 + k"
+            double t = k - half + 1 - (double) p / SincPhases;
+            double x = M_PI * cutoff * t;
+            double sinc = x == 0 ? 1.0 : std::sin(x) / x;
+            double w = t / half;
+            double window = std::fabs(w) >= 1 ? 0 : 0.42 + 0.5 * std::cos(M_PI * w) + 0.08 * std::cos(2 * M_PI * w);
+            row[k] = (float) (sinc * window);
+            sum += row[k];
+        }
+        // unity gain for every phase
+        for (int k = 0; k < SincTaps; k++) {
+            row[k] = (float) (row[k] / sum);
+        }
+    }
+}
+
+void Resampler::setRates(int inputRate, int outputRate) {
+    if (inputRate == m_input_rate && outputRate == m_output_rate) {
+        return;
+    }
+
+    // history is kept so a rate change doesn't click
+    m_input_rate = inputRate;
+    m_output_rate = outputRate;
+    buildTable();
+}
+
+void Resampler::setQuality(Quality quality) {
+    if (quality == m_quality) {
+        return;
+    }
+
+    m_quality = quality;
+    buildTable();
+    reset();
+}
+
+Resampler::Quality Resampler::getQuality() {
+    return m_quality;
+}
+
+int Resampler::getInputRate() {
+    return m_input_rate;
+}
+
+int Resampler::getOutputRate() {
+    return m_output_rate;
+}
+
+void Resampler::reset() {
+    // "half - 1" frames of silence before the first input frame, so the first
+    // output frame is aligned on it with a full filter window
+    int pad = taps() / 2 - 1;
+    for (auto &history: m_history) {
+        if ((int) history.size() < pad) {
+            history.resize((size_t) pad);
+        }
+        std::fill(history.begin(), history.begin() + pad, 0.0f);
+    }
+    m_history_frames = pad;
+    m_position = pad;
+    m_cost_ns = 0;
+    m_cost_frames = 0;
+}
+
+int Resampler::getMaxOutputFrames(int frames, double adjust) {
+    // the history carried from the previous call holds at most a filter window
+    return (int) std::ceil((double) (frames + taps()) * m_output_rate * adjust / m_input_rate) + 1;
+}
+
+int Resampler::process(const int16_t *src, int frames, int16_t *dst, double adjust) {
+    if (frames <= 0) {
+        return 0;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    // append the input to the planar history
+    size_t needed = (size_t) (m_history_frames + frames);
+    for (int c = 0; c < m_channels; c++) {
+        auto &history = m_history[c];
+        if (history.size() < needed) {
+            history.resize(needed);
+        }
+        float *h = history.data() + m_history_frames;
+        for (int i = 0; i < frames; i++) {
+            h[i] = (float) src[i * m_channels + c];
+        }
+    }
+    m_history_frames += frames;
+
+    int half = taps() / 2;
+    double step = (double) m_input_rate / ((double) m_output_rate * adjust);
+    double pos = m_position;
+    int count = 0;
+
+    while ((int) pos + half < m_history_frames) {
+        auto i = (int) pos;
+        auto frac = (float) (pos - i);
+        int16_t *out = dst + count * m_channels;
+
+        if (m_quality == Linear) {
+            for (int c = 0; c < m_channels; c++) {
+                const float *h = m_history[c].data() + i;
+                out[c] = toS16(h[0] + (h[1] - h[0]) * frac);
+            }
+        } else if (m_quality == Cubic) {
+            for (int c = 0; c < m_channels; c++) {
+                const float *h = m_history[c].data() + i;
+                float p0 = h[-1], p1 = h[0], p2 = h[1], p3 = h[2];
+                out[c] = toS16(p1 + 0.5f * frac * (p2 - p0 + frac * (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3
+                                                                     + frac * (3.0f * (p1 - p2) + p3 - p0))));
+            }
+        } else {
+            // interpolate the two nearest phases, then one dot product per channel
+            float phase = frac * SincPhases;
+            auto p = (int) phase;
+            if (p >= SincPhases) p = SincPhases - 1; // float rounding of frac close to 1
+            const float *row = m_table.data() + p * SincTaps;
+            lerp(row, row + SincTaps, phase - (float) p, m_coefs.data(), SincTaps);
+            for (int c = 0; c < m_channels; c++) {
+                out[c] = toS16(dot(m_history[c].data() + i - half + 1, m_coefs.data(), SincTaps));
+            }
+        }
+
+        count++;
+        pos += step;
+    }
+
+    // drop the frames no longer needed by the filter window
+    int drop = (int) pos - half + 1;
+    if (drop > m_history_frames) drop = m_history_frames;
+    if (drop > 0) {
+        for (auto &history: m_history) {
+            memmove(history.data(), history.data() + drop, (m_history_frames - drop) * sizeof(float));
+        }
+        m_history_frames -= drop;
+        pos -= drop;
+    }
+    m_position = pos;
+
+    m_cost_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count();
+    m_cost_frames += count;
+
+    return count;
+}
+
+float Resampler::getCpuCost() {
+    if (m_cost_frames == 0) {
+        return 0;
+    }
+
+    double seconds = (double) m_cost_frames / m_output_rate;
+    return (float) ((double) m_cost_ns / 1000000.0 / seconds);
+}
+
+float Resampler::benchmark(Quality quality, int inputRate, int outputRate, int channels, float seconds) {
+    Resampler resampler(inputRate, outputRate, channels, quality);
+
+    // one "video frame" worth of input, a sweep so the filters don't work on constant data
+    int frames = inputRate / 60;
+    std::vector<int16_t> src((size_t) frames * channels);
+    for (int i = 0; i < frames; i++) {
+        for (int c = 0; c < channels; c++) {
+            src[i * channels + c] = (int16_t) (16384 * std::sin(0.001 * i * i + c));
+        }
+    }
+    std::vector<int16_t> dst((size_t) resampler.getMaxOutputFrames(frames) * channels);
+
+    auto total = (int) ((float) inputRate * seconds);
+    for (int done = 0; done < total; done += frames) {
+        resampler.process(src.data(), frames, dst.data());
+    }
+
+    return resampler.getCpuCost();
+}
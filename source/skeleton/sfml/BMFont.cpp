@@ -45,33 +45,27 @@ namespace c2d {
 
     ////////////////////////////////////////////////////////////
     bool BMFont::loadFromFile(const std::string &fntPath) {
-        size_t size = c2d_renderer->getIo()->getSize(fntPath);
-        const auto data = static_cast<char *>(malloc(size));
-        const size_t len = c2d_renderer->getIo()->read(fntPath, data);
-        if (!data || len < 4) {
+        Io::Map *font = c2d_renderer->getIo()->map(fntPath);
+        if (!font || font->getSize() < 4) {
             printf("BMFont::loadFromFile(%s): could not read font file...\n", fntPath.c_str());
-            if (data) {
-                free(data);
-            }
+            delete (font);
             return false;
         }
 
         const std::string texPath = Utility::removeExt(fntPath) + "_0.png";
-        size = c2d_renderer->getIo()->getSize(fntPath);
-        const auto texData = static_cast<char *>(malloc(size));
-        const size_t texSize = c2d_renderer->getIo()->read(texPath, texData);
-        if (!texData || texSize < 4) {
+        Io::Map *tex = c2d_renderer->getIo()->map(texPath);
+        if (!tex || tex->getSize() < 4) {
             printf("BMFont::loadFromFile(%s): could not read texture file...\n", texPath.c_str());
-            free(data);
-            if (texData) {
-                free(texData);
-            }
+            delete (font);
+            delete (tex);
             return false;
         }
 
-        bool ret = loadFromMemory(data, len, texData, texSize);
-        free(data);
-        free(texData);
+        // both are decoded from the mapped files, nothing is copied
+        bool ret = loadFromMemory((const char *) font->getData(), font->getSize(),
+                                  (const char *) tex->getData(), tex->getSize());
+        delete (font);
+        delete (tex);
         return ret;
     }
 
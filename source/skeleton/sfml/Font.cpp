@@ -27,6 +27,7 @@
 ////////////////////////////////////////////////////////////
 #include <iostream>
 #include <fstream>
+#include <set>
 
 #include "cross2d/c2d.h"
 #include "cross2d/skeleton/sfml/Font.hpp"
@@ -45,6 +46,387 @@
 extern unsigned char c2d_font_default[];
 extern int c2d_font_default_length;
 
+namespace {
+
+    // Build the glyph cache key by combining the code point, bold flag, and outline thickness
+    inline uint64_t glyphKey(uint32_t codePoint, bool bold, float outlineThickness) {
+        return (static_cast<uint64_t>(*&outlineThickness) << 32)
+               | (static_cast<uint64_t>(bold ? 1 : 0) << 31)
+               | static_cast<uint64_t>(codePoint);
+    }
+
+#ifndef __NO_FREETYPE__
+
+    // FreeType objects of a background rasterizer worker, over the (shared, read only) font data
+    struct RasterFace {
+        FT_Library library = nullptr;
+        FT_Face face = nullptr;
+        FT_Stroker stroker = nullptr;
+
+        bool load(const void *data, std::size_t size) {
+            if (face) return true;
+            if (FT_Init_FreeType(&library) != 0) {
+                library = nullptr;
+                return false;
+            }
+            if (FT_New_Memory_Face(library, reinterpret_cast<const FT_Byte *>(data),
+                                   static_cast<FT_Long>(size), 0, &face) != 0
+                || FT_Select_Charmap(face, FT_ENCODING_UNICODE) != 0
+                || FT_Stroker_New(library, &stroker) != 0) {
+                unload();
+                return false;
+            }
+            return true;
+        }
+
+        void unload() {
+            if (stroker) FT_Stroker_Done(stroker);
+            if (face) FT_Done_Face(face);
+            if (library) FT_Done_FreeType(library);
+            stroker = nullptr;
+            face = nullptr;
+            library = nullptr;
+        }
+    };
+
+    // A font file loaded in memory (mapped when supported, so that only the pages holding
+    // the glyphs actually used are read), shared by all the fonts loaded from the same path
+    struct FontFile {
+        std::string path;
+        c2d::Io::Map *map = nullptr;
+        // file content when read without the renderer io (no mapping)
+        std::vector<char> buffer;
+        const void *data = nullptr;
+        std::size_t size = 0;
+        // FreeType objects of the first font loaded from this file, shared by the next ones
+        FT_Library library = nullptr;
+        FT_Face face = nullptr;
+        FT_Stroker stroker = nullptr;
+        int *refCount = nullptr;
+        // background rasterizer faces, one per worker, shared by the fonts using this file
+        std::vector<RasterFace> rasterFaces;
+    };
+
+    // Opened font files, by path. Fonts are loaded and released from the render thread only.
+    std::map<std::string, FontFile *> s_fontFiles;
+
+    FontFile *openFontFile(const std::string &path) {
+        if (!c2d_renderer) {
+            // no io available (font loaded before the renderer), read the file directly
+            std::ifstream stream(path, std::ios::binary | std::ios::ate);
+            if (!stream) {
+                return nullptr;
+            }
+            auto file = new FontFile();
+            file->path = path;
+            file->buffer.resize((size_t) stream.tellg());
+            stream.seekg(0);
+            if (!stream.read(file->buffer.data(), (std::streamsize) file->buffer.size())) {
+                delete (file);
+                return nullptr;
+            }
+            file->data = file->buffer.data();
+            file->size = file->buffer.size();
+            return file;
+        }
+
+        // glyphs are looked up all over the file, read ahead is useless
+        c2d::Io::Map *map = c2d_renderer->getIo()->map(path, c2d::Io::Advice::Random);
+        if (!map) {
+            return nullptr;
+        }
+
+        auto file = new FontFile();
+        file->path = path;
+        file->map = map;
+        file->data = map->getData();
+        file->size = map->getSize();
+
+        return file;
+    }
+
+    void closeFontFile(FontFile *file) {
+        for (auto &face: file->rasterFaces) {
+            face.unload();
+        }
+        delete (file->map);
+        delete (file);
+    }
+
+    // A rasterized glyph, not yet packed into a page texture
+    struct GlyphBitmap {
+        c2d::Glyph glyph;
+        unsigned int width = 0;
+        unsigned int height = 0;
+        std::vector<uint8_t> coverage; ///< 8 bits coverage values, width * height
+    };
+
+    bool setFaceSize(FT_Face face, unsigned int characterSize) {
+        // FT_Set_Pixel_Sizes is an expensive function, so we must call it
+        // only when necessary to avoid killing performances
+        FT_UShort currentSize = face->size->metrics.x_ppem;
+
+        if (currentSize != characterSize) {
+            FT_Error result = FT_Set_Pixel_Sizes(face, 0, characterSize);
+
+            if (result == FT_Err_Invalid_Pixel_Size) {
+                // In the case of bitmap fonts, resizing can
+                // fail if the requested size is not available
+                if (!FT_IS_SCALABLE(face)) {
+                    printf("Failed to set bitmap font size to %i\n", characterSize);
+                    printf("Available sizes are: ");
+                    for (int i = 0; i < face->num_fixed_sizes; ++i)
+                        printf("%i ", face->available_sizes[i].height);
+                    printf("\n");
+                }
+            }
+
+            return result == FT_Err_Ok;
+        } else {
+            return true;
+        }
+    }
+
+    // Rasterize a glyph into a coverage bitmap. This does not touch any shared state,
+    // so it can run on any thread as long as the library, face and stroker are owned by that thread.
+    bool rasterizeGlyph(FT_Library library, FT_Face face, FT_Stroker stroker,
+                        uint32_t codePoint, unsigned int characterSize, bool bold, float outlineThickness,
+                        GlyphBitmap *out) {
+        // Set the character size
+        if (!setFaceSize(face, characterSize))
+            return false;
+
+        // Load the glyph corresponding to the code point
+#ifdef __3DS__
+        // FT_LOAD_FORCE_AUTOHINT crash on 3ds (?!)
+        FT_Int32 flags = FT_LOAD_TARGET_NORMAL;
+#else
+        FT_Int32 flags = FT_LOAD_TARGET_NORMAL | FT_LOAD_FORCE_AUTOHINT;
+#endif
+
+        if (outlineThickness != 0)
+            flags |= FT_LOAD_NO_BITMAP;
+        if (FT_Load_Char(face, codePoint, flags) != 0)
+            return false;
+
+        // Retrieve the glyph
+        FT_Glyph glyphDesc = nullptr;
+        if (FT_Get_Glyph(face->glyph, &glyphDesc)) {
+            printf("Font::loadGlyph: FT_Get_Glyph error\n");
+            return false;
+        }
+
+        // Apply bold and outline (there is no fallback for outline) if necessary -- first technique using outline (highest quality)
+        FT_Pos weight = 1 << 6;
+        bool outline = (glyphDesc->format == FT_GLYPH_FORMAT_OUTLINE);
+        if (outline) {
+            if (bold) {
+                auto outlineGlyph = (FT_OutlineGlyph) glyphDesc;
+                FT_Outline_Embolden(&outlineGlyph->outline, weight);
+            }
+
+            if (outlineThickness != 0) {
+                FT_Stroker_Set(stroker, static_cast<FT_Fixed>(outlineThickness * static_cast<float>(1 << 6)),
+                               FT_STROKER_LINECAP_ROUND, FT_STROKER_LINEJOIN_ROUND, 0);
+                FT_Glyph_Stroke(&glyphDesc, stroker, true);
+            }
+        }
+
+        // Convert the glyph to a bitmap (i.e. rasterize it)
+        if (FT_Glyph_To_Bitmap(&glyphDesc, FT_RENDER_MODE_NORMAL, nullptr, 1)) {
+            printf("Font::loadGlyph(%u): FT_Glyph_To_Bitmap error\n", codePoint);
+            FT_Done_Glyph(glyphDesc);
+            return false;
+        }
+
+        auto bitmapGlyph = reinterpret_cast<FT_BitmapGlyph>(glyphDesc);
+        FT_Bitmap &bitmap = bitmapGlyph->bitmap;
+
+        // Apply bold if necessary -- fallback technique using bitmap (lower quality)
+        if (!outline) {
+            if (bold)
+                FT_Bitmap_Embolden(library, &bitmap, weight, weight);
+
+            if (outlineThickness != 0)
+                printf("Failed to outline glyph (no fallback available)\n");
+        }
+
+        // Compute the glyph's advance offset
+        out->glyph.advance = static_cast<float>(bitmapGlyph->root.advance.x >> 16);
+        if (bold)
+            out->glyph.advance += static_cast<float>(weight) / static_cast<float>(1 << 6);
+
+        out->width = bitmap.width;
+        out->height = bitmap.rows;
+
+        if ((out->width > 0) && (out->height > 0)) {
+            // Compute the glyph's bounding box
+            out->glyph.bounds.left = static_cast<float>(bitmapGlyph->left);
+            out->glyph.bounds.top = static_cast<float>(-bitmapGlyph->top);
+            out->glyph.bounds.width = static_cast<float>(bitmap.width);
+            out->glyph.bounds.height = static_cast<float>(bitmap.rows);
+
+            // Extract the glyph's pixels from the bitmap
+            out->coverage.resize(out->width * out->height);
+            uint8_t *dst = out->coverage.data();
+            const uint8_t *pixels = bitmap.buffer;
+            if (bitmap.pixel_mode == FT_PIXEL_MODE_MONO) {
+                // Pixels are 1 bit monochrome values
+                for (unsigned int y = 0; y < out->height; ++y) {
+                    for (unsigned int x = 0; x < out->width; ++x) {
+                        *dst++ = ((pixels[x / 8]) & (1 << (7 - (x % 8)))) ? 255 : 0;
+                    }
+                    pixels += bitmap.pitch;
+                }
+            } else {
+                // Pixels are 8 bits gray levels
+                for (unsigned int y = 0; y < out->height; ++y) {
+                    memcpy(dst, pixels, out->width);
+                    dst += out->width;
+                    pixels += bitmap.pitch;
+                }
+            }
+        }
+
+        // Delete the FT glyph
+        FT_Done_Glyph(glyphDesc);
+
+        return true;
+    }
+
+    // Background rasterization pool, shared by all the fonts: created with the first rasterizer,
+    // released with the last one (fonts are loaded and released from the render thread only)
+    c2d::ThreadPool *s_rasterPool = nullptr;
+    int s_rasterPoolUsers = 0;
+
+    // Rasterize the glyphs of a font on the shared pool, each worker using its own FreeType
+    // library and face of the font file (or of this rasterizer for fonts loaded from memory)
+    class GlyphRasterizer {
+
+    public:
+        GlyphRasterizer(const void *data, std::size_t size, std::vector<RasterFace> *faces)
+                : m_data(data), m_size(size) {
+            if (!s_rasterPool) {
+                s_rasterPool = new c2d::ThreadPool();
+            }
+            s_rasterPoolUsers++;
+            m_faces = faces ? faces : &m_ownFaces;
+            if (m_faces->empty()) {
+                m_faces->resize(s_rasterPool->getThreadCount());
+            }
+            m_mutex = new c2d::C2DMutex();
+#ifdef C2DCond
+            m_cond = new c2d::C2DCond();
+#endif
+        }
+
+        ~GlyphRasterizer() {
+            // our tasks must be done before releasing the faces
+            wait();
+            for (auto &face: m_ownFaces) {
+                face.unload();
+            }
+            if (--s_rasterPoolUsers == 0) {
+                delete (s_rasterPool);
+                s_rasterPool = nullptr;
+            }
+            delete (m_cond);
+            delete (m_mutex);
+        }
+
+        void push(uint32_t codePoint, unsigned int characterSize, bool bold, float outlineThickness) {
+            Id id = {characterSize, glyphKey(codePoint, bold, outlineThickness)};
+
+            m_mutex->lock();
+            bool queued = !m_queued.insert(id).second;
+            if (!queued) {
+                m_pending++;
+            }
+            m_mutex->unlock();
+            if (queued) {
+                return;
+            }
+
+            s_rasterPool->push([this, id, codePoint, bold, outlineThickness](int worker) {
+                RasterFace &face = (*m_faces)[worker];
+                GlyphBitmap bitmap;
+                bool success = face.load(m_data, m_size)
+                               && rasterizeGlyph(face.library, face.face, face.stroker,
+                                                 codePoint, id.first, bold, outlineThickness, &bitmap);
+                m_mutex->lock();
+                if (success) {
+                    m_done[id] = std::move(bitmap);
+                } else {
+                    // let the render thread handle (and report) it
+                    m_queued.erase(id);
+                }
+                if (--m_pending == 0 && m_cond) {
+                    m_cond->broadcast();
+                }
+                m_mutex->unlock();
+            });
+        }
+
+        bool take(unsigned int characterSize, uint64_t key, GlyphBitmap *bitmap) {
+            bool found = false;
+            Id id = {characterSize, key};
+
+            m_mutex->lock();
+            auto it = m_done.find(id);
+            if (it != m_done.end()) {
+                *bitmap = std::move(it->second);
+                m_done.erase(it);
+                m_queued.erase(id);
+                found = true;
+            }
+            m_mutex->unlock();
+
+            return found;
+        }
+
+        template<typename Fn>
+        void takeAll(Fn fn) {
+            std::map<Id, GlyphBitmap> done;
+
+            m_mutex->lock();
+            done.swap(m_done);
+            for (const auto &it: done) {
+                m_queued.erase(it.first);
+            }
+            m_mutex->unlock();
+
+            for (const auto &it: done) {
+                fn(it.first.first, it.first.second, it.second);
+            }
+        }
+
+        // wait for this font tasks only, the pool is shared with the other fonts. Without
+        // C2DCond the pool runs the tasks inline, none is ever pending here
+        void wait() {
+            m_mutex->lock();
+            while (m_pending > 0 && m_cond) {
+                m_cond->wait(m_mutex);
+            }
+            m_mutex->unlock();
+        }
+
+    private:
+        typedef std::pair<unsigned int, uint64_t> Id; ///< character size, glyph key
+
+        const void *m_data;
+        std::size_t m_size;
+        c2d::Mutex *m_mutex = nullptr;
+        c2d::Cond *m_cond = nullptr;
+        int m_pending = 0; ///< pushed tasks not done yet, guarded by m_mutex
+        std::vector<RasterFace> *m_faces = nullptr;
+        std::vector<RasterFace> m_ownFaces;
+        std::set<Id> m_queued;
+        std::map<Id, GlyphBitmap> m_done;
+    };
+
+#endif
+}
+
 namespace c2d {
 ////////////////////////////////////////////////////////////
     Font::Font() :
@@ -52,8 +434,19 @@ namespace c2d {
             m_face(nullptr),
             m_streamRec(nullptr),
             m_stroker(nullptr),
+            m_rasterizer(nullptr),
+            m_file(nullptr),
+            m_data(nullptr),
+            m_dataSize(0),
             m_refCount(nullptr),
-            m_info() {
+            m_info(),
+#ifdef __3DS__
+            m_pageSize(256, 256),
+#else
+            m_pageSize(512, 512),
+#endif
+            m_maxPages(4),
+            m_useCounter(0) {
     }
 
 ////////////////////////////////////////////////////////////
@@ -64,23 +457,45 @@ namespace c2d {
 ////////////////////////////////////////////////////////////
     bool Font::loadFromFile(const std::string &filename) {
 #ifndef __NO_FREETYPE__
-        std::ifstream file;
-        file.open(filename, std::ios::binary | std::ios::ate);
-        if (!file.is_open()) {
-            return false;
+        // Share the face of an already loaded font using the same file
+        auto it = s_fontFiles.find(filename);
+        if (it != s_fontFiles.end()) {
+            // Take our reference first, we may be releasing this very file
+            FontFile *file = it->second;
+            (*file->refCount)++;
+            cleanup();
+            m_library = file->library;
+            m_face = file->face;
+            m_stroker = file->stroker;
+            m_refCount = file->refCount;
+            m_data = file->data;
+            m_dataSize = file->size;
+            m_file = file;
+            m_font_path = filename;
+            m_info.family = file->face->family_name ? file->face->family_name : std::string();
+            return true;
         }
 
-        std::streampos fileSize = file.tellg();
-        m_buff.resize(static_cast<std::size_t>(fileSize) + 1);
+        FontFile *file = openFontFile(filename);
+        if (!file) {
+            printf("Failed to load font \"%s\" (failed to open file)\n", filename.c_str());
+            return false;
+        }
 
-        file.seekg(0, std::ios::beg);
-        if (!file.read(const_cast<char*>(m_buff.c_str()), fileSize)) {
-            file.close();
+        if (!loadFromMemory(file->data, file->size)) {
+            closeFontFile(file);
             return false;
         }
-        file.close();
 
-        return loadFromMemory((const void *)m_buff.c_str(), fileSize);
+        file->library = static_cast<FT_Library>(m_library);
+        file->face = static_cast<FT_Face>(m_face);
+        file->stroker = static_cast<FT_Stroker>(m_stroker);
+        file->refCount = m_refCount;
+        s_fontFiles[filename] = file;
+        m_file = file;
+        m_font_path = filename;
+
+        return true;
 #else
         return false;
 #endif
@@ -142,6 +557,8 @@ namespace c2d {
         // Store the loaded font in our ugly void* :)
         m_stroker = stroker;
         m_face = face;
+        m_data = data;
+        m_dataSize = sizeInBytes;
 
         // Store the font information
         m_info.family = face->family_name ? face->family_name : std::string();
@@ -161,29 +578,85 @@ namespace c2d {
 ////////////////////////////////////////////////////////////
     const Glyph &Font::getGlyph(uint32_t codePoint, unsigned int characterSize,
                                 bool bold, float outlineThickness) const {
-        // Get the page corresponding to the character size
-        GlyphTable &glyphs = m_pages[characterSize].glyphs;
-        if (m_pages[characterSize].texture != nullptr) {
-            m_pages[characterSize].texture->setFilter(m_filtering);
-        }
+        // Get the pages corresponding to the character size
+        Atlas &atlas = m_atlases[characterSize];
+        GlyphTable &glyphs = atlas.glyphs;
 
         // Build the key by combining the code point, bold flag, and outline thickness
-        uint64_t key = (static_cast<uint64_t>(*&outlineThickness) << 32)
-                       | (static_cast<uint64_t>(bold ? 1 : 0) << 31)
-                       | static_cast<uint64_t>(codePoint);
+        uint64_t key = glyphKey(codePoint, bold, outlineThickness);
 
         // Search the glyph into the cache
         if (auto it = glyphs.find(key); it != glyphs.end()) {
-            // Found: just return it
+            // Found: mark its page as used and return it
+            if (it->second.page < atlas.pages.size()) {
+                atlas.pages[it->second.page]->lastUse = ++m_useCounter;
+            }
             return it->second;
         } else {
-            // Not found: we have to load it
-            Glyph glyph = loadGlyph(codePoint, characterSize, bold, outlineThickness);
+            // Not found: we have to load it, unless it was already rasterized in the background
+            Glyph glyph;
+#ifndef __NO_FREETYPE__
+            GlyphBitmap bitmap;
+            auto rasterizer = static_cast<GlyphRasterizer *>(m_rasterizer);
+            if (rasterizer && rasterizer->take(characterSize, key, &bitmap)) {
+                glyph = writeGlyph(bitmap.glyph, characterSize, bitmap.coverage.data(), bitmap.width, bitmap.height);
+            } else {
+                glyph = loadGlyph(codePoint, characterSize, bold, outlineThickness);
+            }
+#else
+            glyph = loadGlyph(codePoint, characterSize, bold, outlineThickness);
+#endif
             //printf("Font::getGlyph(%c): advance: %f\n", codePoint, glyph.advance);
             return glyphs.emplace(key, glyph).first->second;
         }
     }
 
+////////////////////////////////////////////////////////////
+    void Font::preloadGlyphs(const std::u32string &codePoints, unsigned int characterSize,
+                             bool bold, float outlineThickness, bool wait) {
+#ifndef __NO_FREETYPE__
+        if (!m_face || !m_data) {
+            return;
+        }
+
+        if (!m_rasterizer) {
+            auto file = static_cast<FontFile *>(m_file);
+            m_rasterizer = new GlyphRasterizer(m_data, m_dataSize, file ? &file->rasterFaces : nullptr);
+        }
+
+        auto rasterizer = static_cast<GlyphRasterizer *>(m_rasterizer);
+        GlyphTable &glyphs = m_atlases[characterSize].glyphs;
+        for (const auto &codePoint: codePoints) {
+            if (glyphs.find(glyphKey(codePoint, bold, outlineThickness)) == glyphs.end()) {
+                rasterizer->push(codePoint, characterSize, bold, outlineThickness);
+            }
+        }
+
+        if (wait) {
+            rasterizer->wait();
+            flushGlyphs();
+        }
+#endif
+    }
+
+////////////////////////////////////////////////////////////
+    void Font::flushGlyphs() {
+#ifndef __NO_FREETYPE__
+        auto rasterizer = static_cast<GlyphRasterizer *>(m_rasterizer);
+        if (!rasterizer) {
+            return;
+        }
+
+        rasterizer->takeAll([this](unsigned int characterSize, uint64_t key, const GlyphBitmap &bitmap) {
+            GlyphTable &glyphs = m_atlases[characterSize].glyphs;
+            if (glyphs.find(key) == glyphs.end()) {
+                glyphs.emplace(key, writeGlyph(bitmap.glyph, characterSize,
+                                               bitmap.coverage.data(), bitmap.width, bitmap.height));
+            }
+        });
+#endif
+    }
+
 
 ////////////////////////////////////////////////////////////
     float Font::getKerning(uint32_t first, uint32_t second, unsigned int characterSize, bool bold) const {
@@ -287,13 +760,48 @@ namespace c2d {
 
 ////////////////////////////////////////////////////////////
     Texture *Font::getTexture(unsigned int characterSize) {
-        return m_pages[characterSize].texture;
+        // Always provide the first page, it also holds the underlines square
+        Atlas &atlas = m_atlases[characterSize];
+        if (atlas.pages.empty()) {
+            atlas.pages.push_back(new Page(m_pageSize));
+            atlas.pages.back()->texture->setFilter(m_filtering);
+        }
+
+        return atlas.pages[0]->texture;
+    }
+
+    Texture *Font::getPageTexture(unsigned int characterSize, unsigned int page) {
+        if (page == 0) {
+            return getTexture(characterSize);
+        }
+
+        auto it = m_atlases.find(characterSize);
+        if (it == m_atlases.end() || page >= it->second.pages.size()) {
+            return nullptr;
+        }
+
+        return it->second.pages[page]->texture;
+    }
+
+    unsigned int Font::getGeneration(unsigned int characterSize) const {
+        auto it = m_atlases.find(characterSize);
+        return it != m_atlases.end() ? it->second.generation : 0;
+    }
+
+    void Font::setPageSize(const Vector2i &size) {
+        m_pageSize = size;
+    }
+
+    void Font::setMaxPages(unsigned int maxPages) {
+        m_maxPages = maxPages;
     }
 
     void Font::setFilter(Texture::Filter filter) {
         m_filtering = filter;
-        for (unsigned int i = 0; i < m_pages.size(); i++) {
-            m_pages[i].texture->setFilter(filter);
+        for (auto &atlas: m_atlases) {
+            for (auto page: atlas.second.pages) {
+                page->texture->setFilter(filter);
+            }
         }
     }
 
@@ -312,6 +820,10 @@ namespace c2d {
 ////////////////////////////////////////////////////////////
     void Font::cleanup() {
 #ifndef __NO_FREETYPE__
+        // Stop the background rasterizer first, its faces use our font data
+        delete static_cast<GlyphRasterizer *>(m_rasterizer);
+        m_rasterizer = nullptr;
+
         // Check if we must destroy the FreeType pointers
         if (m_refCount) {
             // Decrease the reference counter
@@ -337,6 +849,13 @@ namespace c2d {
                 // Close the library
                 if (m_library)
                     FT_Done_FreeType(static_cast<FT_Library>(m_library));
+
+                // Release the font file, if any (must be done after FT_Done_Face!)
+                if (m_file) {
+                    auto file = static_cast<FontFile *>(m_file);
+                    s_fontFiles.erase(file->path);
+                    closeFontFile(file);
+                }
             }
         }
 
@@ -346,7 +865,10 @@ namespace c2d {
         m_stroker = nullptr;
         m_streamRec = nullptr;
         m_refCount = nullptr;
-        m_pages.clear();
+        m_file = nullptr;
+        m_data = nullptr;
+        m_dataSize = 0;
+        m_atlases.clear();
         std::vector<uint8_t>().swap(m_pixelBuffer);
 #endif
     }
@@ -355,293 +877,254 @@ namespace c2d {
 ////////////////////////////////////////////////////////////
     Glyph Font::loadGlyph(uint32_t codePoint, unsigned int characterSize, bool bold, float outlineThickness) const {
 #ifndef __NO_FREETYPE__
-        // The glyph to return
-        Glyph glyph;
-
         // First, transform our ugly void* to a FT_Face
         auto face = static_cast<FT_Face>(m_face);
         if (!face)
-            return glyph;
+            return {};
 
-        // Set the character size
-        if (!setCurrentSize(characterSize))
-            return glyph;
+        GlyphBitmap bitmap;
+        if (!rasterizeGlyph(static_cast<FT_Library>(m_library), face, static_cast<FT_Stroker>(m_stroker),
+                            codePoint, characterSize, bold, outlineThickness, &bitmap)) {
+            return {};
+        }
 
-        // Load the glyph corresponding to the code point
-#ifdef __3DS__
-        // FT_LOAD_FORCE_AUTOHINT crash on 3ds (?!)
-        FT_Int32 flags = FT_LOAD_TARGET_NORMAL;
+        return writeGlyph(bitmap.glyph, characterSize, bitmap.coverage.data(), bitmap.width, bitmap.height);
 #else
-        FT_Int32 flags = FT_LOAD_TARGET_NORMAL | FT_LOAD_FORCE_AUTOHINT;
+        return {};
 #endif
+    }
 
-        if (outlineThickness != 0)
-            flags |= FT_LOAD_NO_BITMAP;
-        if (FT_Load_Char(face, codePoint, flags) != 0)
-            return glyph;
 
-        // Retrieve the glyph
-        FT_Glyph glyphDesc = nullptr;
-        if (FT_Get_Glyph(face->glyph, &glyphDesc)) {
-            printf("Font::loadGlyph: FT_Get_Glyph error\n");
+////////////////////////////////////////////////////////////
+    Glyph Font::writeGlyph(Glyph glyph, unsigned int characterSize,
+                           const uint8_t *coverage, unsigned int width, unsigned int height) const {
+        if ((width == 0) || (height == 0)) {
             return glyph;
         }
 
-        // Apply bold and outline (there is no fallback for outline) if necessary -- first technique using outline (highest quality)
-        FT_Pos weight = 1 << 6;
-        bool outline = (glyphDesc->format == FT_GLYPH_FORMAT_OUTLINE);
-        if (outline) {
-            if (bold) {
-                auto outlineGlyph = (FT_OutlineGlyph) glyphDesc;
-                FT_Outline_Embolden(&outlineGlyph->outline, weight);
-            }
+        // Leave a small padding around characters, so that filtering doesn't
+        // pollute them with pixels from neighbors
+        const unsigned int padding = 2;
 
-            if (outlineThickness != 0) {
-                auto stroker = static_cast<FT_Stroker>(m_stroker);
+        width += 2 * padding;
+        height += 2 * padding;
 
-                FT_Stroker_Set(stroker, static_cast<FT_Fixed>(outlineThickness * static_cast<float>(1 << 6)),
-                               FT_STROKER_LINECAP_ROUND, FT_STROKER_LINEJOIN_ROUND, 0);
-                FT_Glyph_Stroke(&glyphDesc, stroker, true);
-            }
-        }
-
-        // Convert the glyph to a bitmap (i.e. rasterize it)
-        if (FT_Glyph_To_Bitmap(&glyphDesc, FT_RENDER_MODE_NORMAL, nullptr, 1)) {
-            printf("Font::loadGlyph(%u): FT_Glyph_To_Bitmap error\n", codePoint);
-            FT_Done_Glyph(glyphDesc);
+        // Find a good position for the new glyph into one of the pages of the character size
+        Atlas &atlas = m_atlases[characterSize];
+        glyph.textureRect = allocGlyphRect(atlas, width, height, &glyph.page);
+        if (glyph.textureRect == IntRect()) {
             return glyph;
         }
 
-        auto bitmapGlyph = reinterpret_cast<FT_BitmapGlyph>(glyphDesc);
-        FT_Bitmap &bitmap = bitmapGlyph->bitmap;
-
-        // Apply bold if necessary -- fallback technique using bitmap (lower quality)
-        if (!outline) {
-            if (bold)
-                FT_Bitmap_Embolden(static_cast<FT_Library>(m_library), &bitmap, weight, weight);
-
-            if (outlineThickness != 0)
-                printf("Failed to outline glyph (no fallback available)\n");
-        }
-
-        // Compute the glyph's advance offset
-        glyph.advance = static_cast<float>(bitmapGlyph->root.advance.x >> 16);
-        if (bold)
-            glyph.advance += static_cast<float>(weight) / static_cast<float>(1 << 6);
-
-        unsigned int width = bitmap.width;
-        unsigned int height = bitmap.rows;
-
-        if ((width > 0) && (height > 0)) {
-            // Leave a small padding around characters, so that filtering doesn't
-            // pollute them with pixels from neighbors
-            const unsigned int padding = 2;
-
-            width += 2 * padding;
-            height += 2 * padding;
-
-            // Get the glyphs page corresponding to the character size
-            Page &page = m_pages[characterSize];
-            page.texture->setFilter(m_filtering);
-
-            // Find a good position for the new glyph into the texture
-            glyph.textureRect = findGlyphRect(page, width, height);
-            if (glyph.textureRect == IntRect()) {
-                return glyph;
-            }
-
-            // Make sure the texture data is positioned in the center
-            // of the allocated texture rectangle
-            glyph.textureRect.left += padding;
-            glyph.textureRect.top += padding;
-            glyph.textureRect.width -= 2 * padding;
-            glyph.textureRect.height -= 2 * padding;
+        Page &page = *atlas.pages[glyph.page];
+        page.lastUse = ++m_useCounter;
 
-            // Compute the glyph's bounding box
-            glyph.bounds.left = static_cast<float>(bitmapGlyph->left);
-            glyph.bounds.top = static_cast<float>(-bitmapGlyph->top);
-            glyph.bounds.width = static_cast<float>(bitmap.width);
-            glyph.bounds.height = static_cast<float>(bitmap.rows);
+        // Make sure the texture data is positioned in the center
+        // of the allocated texture rectangle
+        glyph.textureRect.left += padding;
+        glyph.textureRect.top += padding;
+        glyph.textureRect.width -= 2 * padding;
+        glyph.textureRect.height -= 2 * padding;
 
-            // Resize the pixel buffer to the new size and fill it with transparent white pixels
-            m_pixelBuffer.resize(width * height * 4);
-            uint8_t *current = m_pixelBuffer.data();
-            uint8_t *end = current + width * height * 4;
+        // Resize the pixel buffer to the new size and fill it with transparent white pixels
+        m_pixelBuffer.resize(width * height * 4);
+        uint8_t *current = m_pixelBuffer.data();
+        uint8_t *end = current + width * height * 4;
 
 #ifdef __C2D_ARGB__
-            while (current != end) {
-                (*current++) = 0;
-                (*current++) = 255;
-                (*current++) = 255;
-                (*current++) = 255;
-            }
-#else
-            while (current != end) {
-                (*current++) = 255;
-                (*current++) = 255;
-                (*current++) = 255;
-                (*current++) = 0;
-            }
-#endif
-            // Extract the glyph's pixels from the bitmap
-            const uint8_t *pixels = bitmap.buffer;
-            if (bitmap.pixel_mode == FT_PIXEL_MODE_MONO) {
-                // Pixels are 1 bit monochrome values
-                for (unsigned int y = padding; y < height - padding; ++y) {
-                    for (unsigned int x = padding; x < width - padding; ++x) {
-                        // The color channels remain white, just fill the alpha channel
-                        std::size_t index = x + y * width;
-#ifdef __C2D_ARGB__
-                        m_pixelBuffer[index * 4 + 0] =
-                                static_cast<unsigned char>(((pixels[(x - padding) / 8]) &
-                                                            (1 << (7 - ((x - padding) % 8))))
-                                                           ? 255 : 0);
+        while (current != end) {
+            (*current++) = 0;
+            (*current++) = 255;
+            (*current++) = 255;
+            (*current++) = 255;
+        }
 #else
-                        m_pixelBuffer[index * 4 + 3] =
-                                ((pixels[(x - padding) / 8]) & (1 << (7 - ((x - padding) % 8)))) ? 255 : 0;
+        while (current != end) {
+            (*current++) = 255;
+            (*current++) = 255;
+            (*current++) = 255;
+            (*current++) = 0;
+        }
 #endif
-                    }
-                    pixels += bitmap.pitch;
-                }
-            } else {
-                // Pixels are 8 bits gray levels
-                for (unsigned int y = padding; y < height - padding; ++y) {
-                    for (unsigned int x = padding; x < width - padding; ++x) {
-                        // The color channels remain white, just fill the alpha channel
-                        std::size_t index = x + y * width;
+        // Copy the glyph's coverage into the alpha channel, the color channels remain white
+        for (unsigned int y = padding; y < height - padding; ++y) {
+            for (unsigned int x = padding; x < width - padding; ++x) {
+                std::size_t index = x + y * width;
 #ifdef __C2D_ARGB__
-                        m_pixelBuffer[index * 4 + 0] = pixels[x - padding];
+                m_pixelBuffer[index * 4 + 0] = *coverage++;
 #else
-                        m_pixelBuffer[index * 4 + 3] = pixels[x - padding];
+                m_pixelBuffer[index * 4 + 3] = *coverage++;
 #endif
-                    }
-                    pixels += bitmap.pitch;
-                }
             }
+        }
 
-            // Write the pixels to the texture
-            unsigned int x = glyph.textureRect.left - padding;
-            unsigned int y = glyph.textureRect.top - padding;
-            unsigned int w = glyph.textureRect.width + 2 * padding;
-            unsigned int h = glyph.textureRect.height + 2 * padding;
+        // Write the pixels to the texture
+        unsigned int x = glyph.textureRect.left - padding;
+        unsigned int y = glyph.textureRect.top - padding;
+        unsigned int w = glyph.textureRect.width + 2 * padding;
+        unsigned int h = glyph.textureRect.height + 2 * padding;
 
-            uint8_t *dst;
-            int pitch;
-            IntRect rect = {(int) x, (int) y, (int) w, (int) h};
-            page.texture->lock(&dst, &pitch, rect);
+        uint8_t *dst;
+        int pitch;
+        IntRect rect = {(int) x, (int) y, (int) w, (int) h};
+        page.texture->lock(&dst, &pitch, rect);
 
-            const uint8_t *src = m_pixelBuffer.data();
+        const uint8_t *src = m_pixelBuffer.data();
 
-            for (unsigned int i = 0; i < h; i++) {
-                memcpy(dst, src, w * 4);
-                src += w * 4;
-                dst += pitch;
-            }
-
-            page.texture->setUnpackRowLength(page.texture->getTextureSize().x);
-            page.texture->unlock();
-            page.texture->setUnpackRowLength(0);
+        for (unsigned int i = 0; i < h; i++) {
+            memcpy(dst, src, w * 4);
+            src += w * 4;
+            dst += pitch;
         }
 
-        // Delete the FT glyph
-        FT_Done_Glyph(glyphDesc);
+        page.texture->setUnpackRowLength(page.texture->getTextureSize().x);
+        page.texture->unlock();
+        page.texture->setUnpackRowLength(0);
 
-        // Done :)
         return glyph;
-#else
-        return {};
-#endif
     }
 
-
 ////////////////////////////////////////////////////////////
     IntRect Font::findGlyphRect(Page &page, unsigned int width, unsigned int height) const {
-        // Find the line that fits well the glyph
-        Row *row = nullptr;
-        float bestRatio = 0;
-        for (auto it = page.rows.begin(); it != page.rows.end() && !row; ++it) {
-            float ratio = static_cast<float>(height) / (float) it->height;
-
-            // Ignore rows that are either too small or too high
-            if ((ratio < 0.7f) || (ratio > 1.f))
-                continue;
+        auto texWidth = (unsigned int) page.texture->getTextureSize().x;
+        auto texHeight = (unsigned int) page.texture->getTextureSize().y;
+
+        // Find the skyline position where the glyph bottom is the lowest ("bottom-left" rule),
+        // prefer the narrowest segment on ties to keep wide gaps for wide glyphs
+        size_t bestIndex = page.skyline.size();
+        unsigned int bestY = texHeight, bestWidth = texWidth + 1;
+        for (size_t i = 0; i < page.skyline.size(); i++) {
+            unsigned int x = page.skyline[i].x;
+            if (x + width > texWidth) {
+                break;
+            }
 
-            // Check if there's enough horizontal space left in the row
-            if (width > page.texture->getTextureSize().x - it->width)
-                continue;
+            // The glyph may span several segments: it rests on the highest one
+            unsigned int y = 0, spanned = 0;
+            for (size_t j = i; spanned < width; j++) {
+                y = std::max(y, page.skyline[j].y);
+                spanned += page.skyline[j].width;
+            }
 
-            // Make sure that this new row is the best found so far
-            if (ratio < bestRatio)
+            if (y + height > texHeight) {
                 continue;
+            }
 
-            // The current row passed all the tests: we can select it
-            row = &*it;
-            bestRatio = ratio;
-        }
-
-        // If we didn't find a matching row, create a new one (10% taller than the glyph)
-        if (!row) {
-            unsigned int rowHeight = height + height / 10;
-            while ((page.nextRow + rowHeight >= (unsigned int) page.texture->getTextureSize().y)
-                   || (width >= (unsigned int) page.texture->getTextureSize().x)) {
-                // Not enough space: resize the texture if possible
-                auto texWidth = (unsigned int) page.texture->getTextureSize().x;
-                auto texHeight = (unsigned int) page.texture->getTextureSize().y;
-                if ((texWidth * 2 <= 2048) && (texHeight * 2 <= 2048)) {
-                    //printf("Font:: resizing font texture from %ix%i to %ix%i\n",
-                    //     texWidth, texHeight, texWidth * 2, texHeight * 2);
-                    page.texture->resize({(int) texWidth * 2, (int) texHeight * 2}, true);
-                } else {
-                    // Oops, we've reached the maximum texture size...
-                    printf("Failed to add a new character to the font: the maximum texture size has been reached\n");
-                    return {0, 0, 0, 0};
-                }
+            if (y < bestY || (y == bestY && page.skyline[i].width < bestWidth)) {
+                bestIndex = i;
+                bestY = y;
+                bestWidth = page.skyline[i].width;
             }
+        }
 
-            // We can now create the new row
-            page.rows.emplace_back(page.nextRow, rowHeight);
-            page.nextRow += rowHeight;
-            row = &page.rows.back();
+        if (bestIndex == page.skyline.size()) {
+            return {0, 0, 0, 0};
         }
 
-        // Find the glyph's rectangle on the selected row
-        IntRect rect(Rect<unsigned int>({row->width, row->top}, {width, height}));
+        // Insert the new segment on top of the glyph, then shrink or remove the segments it covers
+        unsigned int x = page.skyline[bestIndex].x;
+        page.skyline.insert(page.skyline.begin() + (long) bestIndex, SkylineNode(x, bestY + height, width));
+        for (size_t i = bestIndex + 1; i < page.skyline.size();) {
+            SkylineNode &node = page.skyline[i];
+            unsigned int right = x + width;
+            if (node.x >= right) {
+                break;
+            }
+            if (node.x + node.width <= right) {
+                page.skyline.erase(page.skyline.begin() + (long) i);
+                continue;
+            }
+            node.width -= right - node.x;
+            node.x = right;
+            break;
+        }
 
-        // Update the row informations
-        row->width += width;
+        // Merge neighbor segments of the same height
+        for (size_t i = 0; i + 1 < page.skyline.size();) {
+            if (page.skyline[i].y == page.skyline[i + 1].y) {
+                page.skyline[i].width += page.skyline[i + 1].width;
+                page.skyline.erase(page.skyline.begin() + (long) i + 1);
+            } else {
+                i++;
+            }
+        }
 
-        return rect;
+        return IntRect(Rect<unsigned int>({x, bestY}, {width, height}));
     }
 
-
 ////////////////////////////////////////////////////////////
-    bool Font::setCurrentSize(unsigned int characterSize) const {
-#ifndef __NO_FREETYPE__
-        // FT_Set_Pixel_Sizes is an expensive function, so we must call it
-        // only when necessary to avoid killing performances
+    IntRect Font::allocGlyphRect(Atlas &atlas, unsigned int width, unsigned int height,
+                                 unsigned int *page) const {
+        if (width > (unsigned int) m_pageSize.x || height + 3 > (unsigned int) m_pageSize.y) {
+            printf("Failed to add a new character to the font: glyph is bigger than the page size\n");
+            return {0, 0, 0, 0};
+        }
 
-        auto face = static_cast<FT_Face>(m_face);
-        FT_UShort currentSize = face->size->metrics.x_ppem;
+        // Try the existing pages, most recent first
+        for (size_t i = atlas.pages.size(); i > 0; i--) {
+            IntRect rect = findGlyphRect(*atlas.pages[i - 1], width, height);
+            if (rect != IntRect()) {
+                *page = (unsigned int) i - 1;
+                return rect;
+            }
+        }
 
-        if (currentSize != characterSize) {
-            FT_Error result = FT_Set_Pixel_Sizes(face, 0, characterSize);
+        // Add a new page if allowed
+        if (m_maxPages == 0 || atlas.pages.size() < m_maxPages) {
+            atlas.pages.push_back(new Page(m_pageSize));
+            atlas.pages.back()->texture->setFilter(m_filtering);
+            *page = (unsigned int) atlas.pages.size() - 1;
+            return findGlyphRect(*atlas.pages.back(), width, height);
+        }
 
-            if (result == FT_Err_Invalid_Pixel_Size) {
-                // In the case of bitmap fonts, resizing can
-                // fail if the requested size is not available
-                if (!FT_IS_SCALABLE(face)) {
-                    printf("Failed to set bitmap font size to %i\n", characterSize);
-                    printf("Available sizes are: ");
-                    for (int i = 0; i < face->num_fixed_sizes; ++i)
-                        printf("%i ", face->available_sizes[i].height);
-                    printf("\n");
-                }
+        // Evict the least recently used page: drop its glyphs and reuse its texture space. Pages
+        // created before a setPageSize keep their texture size, skip those too small for the glyph
+        size_t lru = atlas.pages.size();
+        for (size_t i = 0; i < atlas.pages.size(); i++) {
+            Vector2i size = atlas.pages[i]->texture->getTextureSize();
+            if (width > (unsigned int) size.x || height + 3 > (unsigned int) size.y) {
+                continue;
             }
+            if (lru == atlas.pages.size() || atlas.pages[i]->lastUse < atlas.pages[lru]->lastUse) {
+                lru = i;
+            }
+        }
+        if (lru == atlas.pages.size()) {
+            printf("Failed to add a new character to the font: glyph is bigger than the pages size\n");
+            return {0, 0, 0, 0};
+        }
 
-            return result == FT_Err_Ok;
-        } else {
-            return true;
+        // Check the glyph fits the emptied page before dropping anything
+        Page &evicted = *atlas.pages[lru];
+        std::vector<SkylineNode> skyline;
+        skyline.swap(evicted.skyline);
+        evicted.skyline.assign(1, SkylineNode(0, 3, (unsigned int) evicted.texture->getTextureSize().x));
+        IntRect rect = findGlyphRect(evicted, width, height);
+        if (rect == IntRect()) {
+            evicted.skyline.swap(skyline);
+            printf("Failed to add a new character to the font: glyph doesn't fit an empty page\n");
+            return {0, 0, 0, 0};
         }
+
+        for (auto it = atlas.glyphs.begin(); it != atlas.glyphs.end();) {
+            if (it->second.page == lru) {
+                it = atlas.glyphs.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        atlas.generation++;
+
+        *page = (unsigned int) lru;
+        return rect;
+    }
+
+
+////////////////////////////////////////////////////////////
+    bool Font::setCurrentSize(unsigned int characterSize) const {
+#ifndef __NO_FREETYPE__
+        return setFaceSize(static_cast<FT_Face>(m_face), characterSize);
 #else
         return false;
 #endif
@@ -654,9 +1137,12 @@ namespace c2d {
 
 ////////////////////////////////////////////////////////////
 
-    Font::Page::Page() : nextRow(3) {
+    Font::Page::Page(const Vector2i &size) {
         //printf("Font:: create new tex\n");
-        texture = new C2DTexture({128, 128}, Texture::Format::RGBA8);
+        texture = new C2DTexture(size, Texture::Format::RGBA8);
+
+        // Glyphs are packed below the underlines square
+        skyline.emplace_back(0, 3, (unsigned int) size.x);
 
         // Reserve a 2x2 white square for texturing underlines
         uint8_t *buffer;
@@ -680,4 +1166,10 @@ namespace c2d {
         delete (texture);
     }
 
+    Font::Atlas::~Atlas() {
+        for (auto page: pages) {
+            delete (page);
+        }
+    }
+
 } // namespace sf
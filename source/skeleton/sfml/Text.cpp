@@ -28,8 +28,6 @@
 #include <cmath>
 #include "cross2d/c2d.h"
 #include "cross2d/skeleton/sfml/Utf.hpp"
-#include <codecvt>
-#include <locale>
 
 using namespace c2d;
 
@@ -116,6 +114,16 @@ namespace c2d {
         }
     }
 
+////////////////////////////////////////////////////////////
+    Text::~Text() {
+        for (auto vertices: m_pageVertices) {
+            delete (vertices);
+        }
+        for (auto vertices: m_pageOutlineVertices) {
+            delete (vertices);
+        }
+    }
+
 
 ////////////////////////////////////////////////////////////
     void Text::setString(const std::string &string) {
@@ -165,10 +173,13 @@ namespace c2d {
             m_fillColor = color;
 
             if (!m_geometryNeedUpdate) {
-                for (std::size_t i = 0; i < m_vertices.getVertexCount(); ++i) {
-                    m_vertices[i].color = m_fillColor;
+                for (std::size_t page = 0; page <= m_pageVertices.size(); ++page) {
+                    VertexArray &vertices = getPageVertices(page, false);
+                    for (std::size_t i = 0; i < vertices.getVertexCount(); ++i) {
+                        vertices[i].color = m_fillColor;
+                    }
+                    vertices.update();
                 }
-                m_vertices.update();
             }
         }
     }
@@ -179,10 +190,13 @@ namespace c2d {
             m_outlineColor = color;
 
             if (!m_geometryNeedUpdate) {
-                for (std::size_t i = 0; i < m_outlineVertices.getVertexCount(); ++i) {
-                    m_outlineVertices[i].color = m_outlineColor;
+                for (std::size_t page = 0; page <= m_pageOutlineVertices.size(); ++page) {
+                    VertexArray &vertices = getPageVertices(page, true);
+                    for (std::size_t i = 0; i < vertices.getVertexCount(); ++i) {
+                        vertices[i].color = m_outlineColor;
+                    }
+                    vertices.update();
                 }
-                m_outlineVertices.update();
             }
         }
     }
@@ -379,8 +393,10 @@ namespace c2d {
             return;
         }
 
+        // Rebuild the geometry if the font pages changed, or if some of them were evicted
         Vector2i texSize = m_font->getTexture(m_characterSize)->getTextureSize();
-        if (!m_font->isBmFont() && texSize != m_textureSize) {
+        unsigned int generation = m_font->getGeneration(m_characterSize);
+        if (!m_font->isBmFont() && (texSize != m_textureSize || generation != m_generation)) {
             m_textureSize = texSize;
             m_geometryNeedUpdate = true;
             ensureGeometryUpdate();
@@ -399,14 +415,39 @@ namespace c2d {
 
         if (draw) {
             Transform combined = transform * getTransform();
+            // Glyphs may be spread on several font pages, draw each page with its own texture
             if (getOutlineThickness() > 0) {
-                c2d_renderer->draw(&m_outlineVertices, combined, m_font->getTexture(m_characterSize));
+                for (unsigned int page = 0; page <= m_pageOutlineVertices.size(); page++) {
+                    VertexArray &vertices = getPageVertices(page, true);
+                    if (vertices.getVertexCount() > 0) {
+                        c2d_renderer->draw(&vertices, combined, m_font->getPageTexture(m_characterSize, page));
+                    }
+                }
+            }
+            for (unsigned int page = 0; page <= m_pageVertices.size(); page++) {
+                VertexArray &vertices = getPageVertices(page, false);
+                if (vertices.getVertexCount() > 0) {
+                    c2d_renderer->draw(&vertices, combined, m_font->getPageTexture(m_characterSize, page));
+                }
             }
-            c2d_renderer->draw(&m_vertices, combined, m_font->getTexture(m_characterSize));
         }
         C2DObject::onDraw(transform, draw);
     }
 
+////////////////////////////////////////////////////////////
+    VertexArray &Text::getPageVertices(unsigned int page, bool outline) const {
+        if (page == 0) {
+            return outline ? m_outlineVertices : m_vertices;
+        }
+
+        std::vector<VertexArray *> &pages = outline ? m_pageOutlineVertices : m_pageVertices;
+        while (pages.size() < page) {
+            pages.push_back(new VertexArray(Triangles));
+        }
+
+        return *pages[page - 1];
+    }
+
 ////////////////////////////////////////////////////////////
 Vector2f Text::findCharacterPos(std::size_t index) const {
     // Make sure that we have a valid font
@@ -414,9 +455,7 @@ Vector2f Text::findCharacterPos(std::size_t index) const {
         return {};
 
     // Convert UTF-8 string to UTF-32 for proper character indexing
-	    // Convert UTF-8 to UTF-32
-    std::wstring_convert<std::codecvt_utf8<char32_t>, char32_t> converter;
-    std::u32string utf32String = converter.from_bytes(m_string);
+    std::u32string utf32String = Utility::utf8ToUtf32(m_string);
 
     // Adjust the index if it's out of range
     if (index > utf32String.length())
@@ -469,9 +508,25 @@ void Text::ensureGeometryUpdate() const {
 
     if (!m_font || m_string.empty()) return;
 
+    // Glyphs loaded by a pass may evict a page holding glyphs of that same pass, leaving
+    // quads pointing to reused texture space: build again with the pages then in place.
+    // A text needing more glyphs than all the pages can hold never settles, keep the last pass
+    for (int pass = 0; pass < 3; pass++) {
+        unsigned int generation = m_font->getGeneration(m_characterSize);
+        buildGeometry();
+        m_generation = m_font->getGeneration(m_characterSize);
+        if (m_generation == generation) {
+            break;
+        }
+    }
+}
+
+void Text::buildGeometry() const {
     // 清除之前的几何数据
     m_vertices.clear();
     m_outlineVertices.clear();
+    for (auto vertices: m_pageVertices) vertices->clear();
+    for (auto vertices: m_pageOutlineVertices) vertices->clear();
     m_bounds = FloatRect();
 
     // 获取样式信息
@@ -482,6 +537,12 @@ void Text::ensureGeometryUpdate() const {
     float underlineOffset = m_font->getUnderlinePosition(m_characterSize);
     float underlineThickness = m_font->getUnderlineThickness(m_characterSize);
 
+    // Pages created before a Font::setPageSize call keep their size, map each glyph with its own page
+    auto pageSize = [this](unsigned int page) {
+        Texture *texture = m_font->getPageTexture(m_characterSize, page);
+        return texture ? texture->getTextureSize() : m_textureSize;
+    };
+
     // 计算行高和空格宽度
     float hspace = static_cast<float>(m_font->getGlyph(U' ', m_characterSize, bold).advance);
     float vspace = static_cast<float>(m_font->getLineSpacing(m_characterSize)) + m_line_spacing;
@@ -501,8 +562,7 @@ void Text::ensureGeometryUpdate() const {
     uint32_t prevChar = 0;
 
     // 转换为UTF-32处理
-    std::wstring_convert<std::codecvt_utf8<char32_t>, char32_t> converter;
-    std::u32string utf32String = converter.from_bytes(m_string);
+    std::u32string utf32String = Utility::utf8ToUtf32(m_string);
     
     // 判断是否为单行模式，转义下原定义懒得修改后面的代码了
 	bool singleLineMode = m_overflow ? false : true;
@@ -570,7 +630,8 @@ void Text::ensureGeometryUpdate() const {
         }
 
         // 获取当前字符的字形信息
-        const Glyph& glyph = m_font->getGlyph(curChar, m_characterSize, bold);
+        // 复制字形: 后续加载轮廓字形可能淘汰其所在页
+        const Glyph glyph = m_font->getGlyph(curChar, m_characterSize, bold);
         
         // 检查是否超出水平边界（考虑可能的省略号）
         float newX = x + glyph.advance;
@@ -609,7 +670,7 @@ void Text::ensureGeometryUpdate() const {
         // 添加轮廓(如果有)
         if (m_outlineThickness != 0) {
             const Glyph& outlineGlyph = m_font->getGlyph(curChar, m_characterSize, bold, m_outlineThickness);
-            addGlyphQuad(m_outlineVertices, m_textureSize, {x, y}, m_outlineColor, outlineGlyph, italic);
+            addGlyphQuad(getPageVertices(outlineGlyph.page, true), pageSize(outlineGlyph.page), {x, y}, m_outlineColor, outlineGlyph, italic);
             
             // 更新带轮廓的边界
             float left = outlineGlyph.bounds.left - m_outlineThickness;
@@ -624,7 +685,7 @@ void Text::ensureGeometryUpdate() const {
         }
 
         // 添加主字形
-        addGlyphQuad(m_vertices, m_textureSize, {x, y}, m_fillColor, glyph, italic);
+        addGlyphQuad(getPageVertices(glyph.page, false), pageSize(glyph.page), {x, y}, m_fillColor, glyph, italic);
 
         // 更新无轮廓的边界
         float left = glyph.bounds.left;
@@ -646,16 +707,16 @@ add_ellipsis:
     if (truncated && singleLineMode && (x + ellipsisWidth) <= availableWidth) {
         // 添加三个点作为省略号
         for (int i = 0; i < 3; ++i) {
-            const Glyph& dotGlyph = m_font->getGlyph(U'.', m_characterSize, bold);
+            const Glyph dotGlyph = m_font->getGlyph(U'.', m_characterSize, bold);
             
             // 添加轮廓
             if (m_outlineThickness != 0) {
                 const Glyph& outlineDotGlyph = m_font->getGlyph(U'.', m_characterSize, bold, m_outlineThickness);
-                addGlyphQuad(m_outlineVertices, m_textureSize, {x, y}, m_outlineColor, outlineDotGlyph, italic);
+                addGlyphQuad(getPageVertices(outlineDotGlyph.page, true), pageSize(outlineDotGlyph.page), {x, y}, m_outlineColor, outlineDotGlyph, italic);
             }
             
             // 添加主字形
-            addGlyphQuad(m_vertices, m_textureSize, {x, y}, m_fillColor, dotGlyph, italic);
+            addGlyphQuad(getPageVertices(dotGlyph.page, false), pageSize(dotGlyph.page), {x, y}, m_fillColor, dotGlyph, italic);
             
             // 更新边界
             float left = dotGlyph.bounds.left;
@@ -674,9 +735,9 @@ add_ellipsis:
 
     // 添加行尾的下划线
     if (underlined && x > 0) {
-        addLine(m_vertices, m_textureSize, x, y, m_fillColor, underlineOffset, underlineThickness);
+        addLine(m_vertices, pageSize(0), x, y, m_fillColor, underlineOffset, underlineThickness);
         if (m_outlineThickness != 0) {
-            addLine(m_outlineVertices, m_textureSize, x, y, 
+            addLine(m_outlineVertices, pageSize(0), x, y, 
                    m_outlineColor, underlineOffset, underlineThickness, m_outlineThickness);
         }
     }
@@ -686,9 +747,9 @@ add_ellipsis:
         FloatRect xBounds = m_font->getGlyph(U'x', m_characterSize, bold).bounds;
         float strikeThroughOffset = xBounds.top + xBounds.height / 2.f;
         
-        addLine(m_vertices, m_textureSize, x, y, m_fillColor, strikeThroughOffset, underlineThickness);
+        addLine(m_vertices, pageSize(0), x, y, m_fillColor, strikeThroughOffset, underlineThickness);
         if (m_outlineThickness != 0) {
-            addLine(m_outlineVertices, m_textureSize, x, y,
+            addLine(m_outlineVertices, pageSize(0), x, y,
                    m_outlineColor, strikeThroughOffset, underlineThickness, m_outlineThickness);
         }
     }
@@ -699,6 +760,8 @@ add_ellipsis:
 
     m_vertices.update();
     m_outlineVertices.update();
+    for (auto vertices: m_pageVertices) vertices->update();
+    for (auto vertices: m_pageOutlineVertices) vertices->update();
 }
 
 
@@ -30,8 +30,14 @@ Texture::Texture(const std::string &p) : RectangleShape({0, 0}) {
     m_bpp = 4;
     m_path = p;
 
-    // load pixels buffer
-    m_pixels = stbi_load(m_path.c_str(), &w, &h, &n, m_bpp);
+    // load pixels buffer, decoded from the mapped file when the io is available
+    Io::Map *map = c2d_renderer ? c2d_renderer->getIo()->map(m_path) : nullptr;
+    if (map) {
+        m_pixels = stbi_load_from_memory(map->getData(), (int) map->getSize(), &w, &h, &n, m_bpp);
+        delete (map);
+    } else {
+        m_pixels = stbi_load(m_path.c_str(), &w, &h, &n, m_bpp);
+    }
     if (!m_pixels) {
         printf("Texture(%p): stbi_load failed (%s): %s\n", this, m_path.c_str(), stbi_failure_reason());
         return;
@@ -0,0 +1,135 @@
+//
+// Created by cpasjuste on 17/10/2026.
+//
+
+#include "cross2d/c2d.h"
+
+using namespace c2d;
+
+#if defined(C2DThread) && defined(C2DCond)
+#define C2D_THREAD_POOL_THREADED 1
+#endif
+
+ThreadPool::ThreadPool(int threads) {
+#ifdef C2D_THREAD_POOL_THREADED
+    if (threads <= 0) {
+        threads = C2DDevice::getCpuCount() - 1;
+        if (threads < 1) threads = 1;
+    }
+
+    m_mutex = new C2DMutex();
+    m_cond = new C2DCond();
+    m_idle_cond = new C2DCond();
+
+    // workers keep a pointer to their slot, don't let the vector reallocate
+    m_workers.resize(threads);
+    for (int i = 0; i < threads; i++) {
+        m_workers[i].pool = this;
+        m_workers[i].index = i;
+        m_workers[i].thread = new C2DThread(workerThread, &m_workers[i]);
+    }
+#endif
+}
+
+int ThreadPool::workerThread(void *data) {
+    auto worker = (Worker *) data;
+    auto pool = worker->pool;
+
+    pool->m_mutex->lock();
+    while (true) {
+        while (!pool->m_quit && pool->m_tasks.empty()) {
+            pool->m_cond->wait(pool->m_mutex);
+        }
+        if (pool->m_quit) {
+            break;
+        }
+
+        Task task = std::move(pool->m_tasks.front());
+        pool->m_tasks.pop_front();
+        pool->m_busy++;
+        pool->m_mutex->unlock();
+
+        task(worker->index);
+
+        pool->m_mutex->lock();
+        pool->m_busy--;
+        if (pool->m_busy == 0 && pool->m_tasks.empty()) {
+            pool->m_idle_cond->broadcast();
+        }
+    }
+    pool->m_mutex->unlock();
+
+    return 0;
+}
+
+void ThreadPool::push(const Task &task) {
+    if (m_workers.empty()) {
+        task(0);
+        return;
+    }
+
+    m_mutex->lock();
+    m_tasks.push_back(task);
+    m_cond->signal();
+    m_mutex->unlock();
+}
+
+void ThreadPool::wait() {
+    if (m_workers.empty()) {
+        return;
+    }
+
+    m_mutex->lock();
+    while (m_busy > 0 || !m_tasks.empty()) {
+        m_idle_cond->wait(m_mutex);
+    }
+    m_mutex->unlock();
+}
+
+void ThreadPool::clear() {
+    if (m_workers.empty()) {
+        return;
+    }
+
+    m_mutex->lock();
+    m_tasks.clear();
+    if (m_busy == 0) {
+        m_idle_cond->broadcast();
+    }
+    m_mutex->unlock();
+}
+
+int ThreadPool::getThreadCount() const {
+    return m_workers.empty() ? 1 : (int) m_workers.size();
+}
+
+int ThreadPool::getPending() {
+    if (m_workers.empty()) {
+        return 0;
+    }
+
+    m_mutex->lock();
+    int pending = (int) m_tasks.size() + m_busy;
+    m_mutex->unlock();
+
+    return pending;
+}
+
+ThreadPool::~ThreadPool() {
+    if (!m_workers.empty()) {
+        m_mutex->lock();
+        m_tasks.clear();
+        m_quit = true;
+        m_cond->broadcast();
+        m_mutex->unlock();
+
+        for (auto &worker: m_workers) {
+            worker.thread->join();
+            delete (worker.thread);
+        }
+    }
+
+    delete (m_idle_cond);
+    delete (m_cond);
+    delete (m_mutex);
+}
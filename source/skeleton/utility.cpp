@@ -3,8 +3,16 @@
 //
 
 #include <algorithm>
+#include <cstring>
+#include <chrono>
 #include "cross2d/c2d.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 using namespace c2d;
 
 typedef std::mt19937 RandomEngine;
@@ -222,19 +230,163 @@ int Utility::getCharacterBytes(unsigned char firstByte)
 
 int Utility::getCharacterNum(std::string &str)
 {
-    int count = 0;
+    // count only, nothing is decoded nor allocated
+    return (int) utf8ToUtf32(str.data(), str.size(), nullptr);
+}
 
-    for (size_t i = 0; i < str.size(); ) {
-        int bytesToRead = Utility::getCharacterBytes(static_cast<unsigned char>(str[i]));
-        if (bytesToRead < 0)
-        {
-            count++;
+// Widen 16 ASCII bytes to code points, returns false if any byte isn't ASCII
+static inline bool asciiBlock16(const unsigned char *src, char32_t *dst) {
+#if defined(__SSE2__)
+    __m128i bytes = _mm_loadu_si128((const __m128i *) src);
+    if (_mm_movemask_epi8(bytes) != 0) {
+        return false;
+    }
+    __m128i zero = _mm_setzero_si128();
+    __m128i lo = _mm_unpacklo_epi8(bytes, zero);
+    __m128i hi = _mm_unpackhi_epi8(bytes, zero);
+    _mm_storeu_si128((__m128i *) dst + 0, _mm_unpacklo_epi16(lo, zero));
+    _mm_storeu_si128((__m128i *) dst + 1, _mm_unpackhi_epi16(lo, zero));
+    _mm_storeu_si128((__m128i *) dst + 2, _mm_unpacklo_epi16(hi, zero));
+    _mm_storeu_si128((__m128i *) dst + 3, _mm_unpackhi_epi16(hi, zero));
+    return true;
+#elif defined(__ARM_NEON)
+    uint8x16_t bytes = vld1q_u8(src);
+#if defined(__aarch64__)
+    if (vmaxvq_u8(bytes) >= 0x80) {
+        return false;
+    }
+#else
+    uint64x2_t words = vreinterpretq_u64_u8(bytes);
+    if ((vgetq_lane_u64(words, 0) | vgetq_lane_u64(words, 1)) & 0x8080808080808080ULL) {
+        return false;
+    }
+#endif
+    uint16x8_t lo = vmovl_u8(vget_low_u8(bytes));
+    uint16x8_t hi = vmovl_u8(vget_high_u8(bytes));
+    auto out = (uint32_t *) dst;
+    vst1q_u32(out + 0, vmovl_u16(vget_low_u16(lo)));
+    vst1q_u32(out + 4, vmovl_u16(vget_high_u16(lo)));
+    vst1q_u32(out + 8, vmovl_u16(vget_low_u16(hi)));
+    vst1q_u32(out + 12, vmovl_u16(vget_high_u16(hi)));
+    return true;
+#else
+    uint64_t words[2];
+    memcpy(words, src, sizeof(words));
+    if ((words[0] | words[1]) & 0x8080808080808080ULL) {
+        return false;
+    }
+    for (int i = 0; i < 16; i++) {
+        dst[i] = src[i];
+    }
+    return true;
+#endif
+}
+
+// Check that 16 bytes are ASCII, for counting
+static inline bool isAscii16(const unsigned char *src) {
+#if defined(__SSE2__)
+    return _mm_movemask_epi8(_mm_loadu_si128((const __m128i *) src)) == 0;
+#else
+    uint64_t words[2];
+    memcpy(words, src, sizeof(words));
+    return ((words[0] | words[1]) & 0x8080808080808080ULL) == 0;
+#endif
+}
+
+// Decode = false only counts the code points, "dst" is not used
+template<bool Decode>
+static size_t decodeUtf8(const unsigned char *s, size_t len, char32_t *dst, char32_t replacement) {
+    size_t i = 0, count = 0;
+
+    while (i < len) {
+        // ASCII fast path, 16 bytes at a time
+        while (i + 16 <= len && (Decode ? asciiBlock16(s + i, dst + count) : isAscii16(s + i))) {
+            i += 16;
+            count += 16;
+        }
+        if (i >= len) {
             break;
         }
 
-        i += bytesToRead;
+        unsigned char c = s[i];
+        if (c < 0x80) {
+            if (Decode) dst[count] = c;
+            count++;
+            i++;
+            continue;
+        }
+
+        // Multi-bytes sequence: get its length, its minimal value (to reject overlong forms)
+        // and the payload bits of the leading byte
+        size_t n;
+        char32_t cp, min;
+        if ((c & 0xE0) == 0xC0) {
+            n = 2, cp = c & 0x1F, min = 0x80;
+        } else if ((c & 0xF0) == 0xE0) {
+            n = 3, cp = c & 0x0F, min = 0x800;
+        } else if ((c & 0xF8) == 0xF0) {
+            n = 4, cp = c & 0x07, min = 0x10000;
+        } else {
+            // stray continuation byte or obsolete 5/6 bytes form
+            if (Decode) dst[count] = replacement;
+            count++;
+            i++;
+            continue;
+        }
+
+        size_t k = 1;
+        for (; k < n && i + k < len && (s[i + k] & 0xC0) == 0x80; k++) {
+            cp = (cp << 6) | (s[i + k] & 0x3F);
+        }
+
+        if (k < n || cp < min || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) {
+            // truncated, overlong, out of range or surrogate: skip the leading byte only
+            if (Decode) dst[count] = replacement;
+            count++;
+            i++;
+            continue;
+        }
+
+        if (Decode) dst[count] = cp;
         count++;
+        i += n;
     }
 
     return count;
 }
+
+size_t Utility::utf8ToUtf32(const char *src, size_t len, char32_t *dst, char32_t replacement) {
+    auto s = (const unsigned char *) src;
+    return dst ? decodeUtf8<true>(s, len, dst, replacement) : decodeUtf8<false>(s, len, nullptr, replacement);
+}
+
+std::u32string Utility::utf8ToUtf32(const std::string &str, char32_t replacement) {
+    std::u32string out(str.size(), 0);
+    out.resize(utf8ToUtf32(str.data(), str.size(), &out[0], replacement));
+    return out;
+}
+
+void Utility::writeLE(FILE *file, uint64_t value, int bytes) {
+    uint8_t b[8];
+    for (int i = 0; i < bytes; i++) {
+        b[i] = (uint8_t) (value >> (i * 8));
+    }
+    fwrite(b, 1, (size_t) bytes, file);
+}
+
+bool Utility::readLE(FILE *file, uint64_t *value, int bytes) {
+    uint8_t b[8];
+    if (fread(b, 1, (size_t) bytes, file) != (size_t) bytes) {
+        return false;
+    }
+    *value = 0;
+    for (int i = 0; i < bytes; i++) {
+        *value |= (uint64_t) b[i] << (i * 8);
+    }
+    return true;
+}
+
+int64_t Utility::getTimeUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
@@ -0,0 +1,85 @@
+//
+// Created by cpasjuste on 17/10/2026.
+//
+
+// IoHasher known answer checks: FIPS 180 SHA1 vectors and the CRC32 check value, then a
+// file bigger than C2D_IO_HASH_CHUNK_SIZE hashed through an Io (chunked updates) against
+// the one shot functions.
+//
+// usage: c2d_hash_check [scratch directory]
+
+#include <cstring>
+#include "cross2d/c2d.h"
+
+using namespace c2d;
+
+static int failures = 0;
+
+static std::string hex(const uint8_t *data, size_t size) {
+    static const char *digits = "0123456789abcdef";
+    std::string str;
+    for (size_t i = 0; i < size; i++) {
+        str += digits[data[i] >> 4];
+        str += digits[data[i] & 0x0F];
+    }
+    return str;
+}
+
+static void check(const char *name, const std::string &result, const std::string &expected) {
+    bool ok = result == expected;
+    printf("%-28s %s%s%s\n", name, ok ? "ok" : "FAILED: ", ok ? "" : result.c_str(),
+           ok ? "" : (" (expected " + expected + ")").c_str());
+    failures += !ok;
+}
+
+static std::string sha1(const std::string &data) {
+    uint8_t digest[20];
+    IoHasher::sha1((const uint8_t *) data.data(), data.size(), digest);
+    return hex(digest, 20);
+}
+
+static std::string crc(uint32_t value) {
+    char str[16];
+    snprintf(str, sizeof(str), "%08x", value);
+    return str;
+}
+
+int main(int argc, char **argv) {
+    // FIPS 180 examples
+    check("sha1 \"\"", sha1(""), "da39a3ee5e6b4b0d3255bfef95601890afd80709");
+    check("sha1 \"abc\"", sha1("abc"), "a9993e364706816aba3e25717850c26c9cd0d89d");
+    check("sha1 448 bits", sha1("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"),
+          "84983e441c3bd26ebaae4aa1f95129e5e54670f1");
+    check("sha1 1M 'a'", sha1(std::string(1000000, 'a')), "34aa973cd4c4daa4f61eeb2bdbad27316534016f");
+
+    const char *digits = "123456789";
+    check("crc32 \"123456789\"", crc(IoHasher::crc32(0, (const uint8_t *) digits, 9)), "cbf43926");
+    check("crc32 \"12345\" + \"6789\"",
+          crc(IoHasher::crc32(IoHasher::crc32(0, (const uint8_t *) digits, 5), (const uint8_t *) digits + 5, 4)),
+          "cbf43926");
+
+    // not a multiple of the chunk size nor of the sha1 block size
+    std::vector<uint8_t> data(C2D_IO_HASH_CHUNK_SIZE * 3 + 7);
+    for (size_t i = 0; i < data.size(); i++) {
+        data[i] = (uint8_t) (i * 2654435761u >> 24);
+    }
+    uint8_t digest[20];
+    IoHasher::sha1(data.data(), data.size(), digest);
+    uint32_t value = IoHasher::crc32(0, data.data(), data.size());
+
+    C2DIo io;
+    std::string file = std::string(argc > 1 ? argv[1] : ".") + "/c2d_hash_check.bin";
+    if (!io.write(file, (const char *) data.data(), data.size())) {
+        printf("hash_check: could not write %s\n", file.c_str());
+        return 1;
+    }
+    IoHasher hasher(&io);
+    IoHasher::Hash hash = hasher.hash(file, IoHasher::Crc32 | IoHasher::Sha1);
+    io.removeFile(file);
+    check("io crc32", hash.getCrcString(), crc(value));
+    check("io sha1", hash.getSha1String(), hex(digest, 20));
+
+    printf("hash_check: %s\n", failures ? "FAILED" : "all passed");
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,277 @@
+//
+// Created by cpasjuste on 17/10/2026.
+//
+
+// Build time romfs packer: writes a directory tree into a single zip archive, mounted at
+// runtime over the romfs path by ZipIo (see Renderer::Renderer). Stored entries data are
+// aligned so the runtime can serve them from the archive mapping without copy, entries
+// which compress well are deflated. Standalone (zlib only), it runs on the build host.
+//
+// usage: romfs_pack [-a alignment] [-l level] <romfs directory> <output.pak>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <zlib.h>
+
+#define ZIP_LOCAL_HEADER_SIG 0x04034b50
+#define ZIP_CENTRAL_HEADER_SIG 0x02014b50
+#define ZIP_END_SIG 0x06054b50
+// zipalign padding extra field id
+#define ZIP_ALIGN_EXTRA_ID 0xD935
+#define ZIP_FLAG_UTF8 0x0800
+
+struct Entry {
+    std::string path;   // archive relative, '/' separated
+    std::string name;   // path on disk
+    uint32_t crc = 0;
+    uint32_t size = 0;
+    uint32_t compressedSize = 0;
+    uint32_t offset = 0;
+    uint16_t method = 0;
+    uint16_t date = 0;
+    uint16_t time = 0;
+};
+
+// already compressed formats, deflating them only costs load time
+static const char *stored[] = {".png", ".jpg", ".jpeg", ".webp", ".ogg", ".mp3", ".opus", ".flac",
+                               ".zip", ".7z", ".gz", ".xz", ".bz2", ".pak", nullptr};
+
+static void put(std::vector<uint8_t> *out, uint32_t v, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        out->push_back((uint8_t) (v >> (i * 8)));
+    }
+}
+
+static bool isStored(const std::string &path) {
+    size_t dot = path.rfind('.');
+    if (dot == std::string::npos) {
+        return false;
+    }
+    std::string ext = path.substr(dot);
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    for (int i = 0; stored[i]; i++) {
+        if (ext == stored[i]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void walk(const std::string &root, const std::string &dir, std::vector<Entry> *entries) {
+    DIR *d = opendir((root + "/" + dir).c_str());
+    if (!d) {
+        return;
+    }
+
+    struct dirent *ent;
+    while ((ent = readdir(d)) != nullptr) {
+        if (strcmp(ent->d_name, ".") == 0 || strcmp(ent->d_name, "..") == 0) {
+            continue;
+        }
+        std::string path = dir.empty() ? ent->d_name : dir + "/" + ent->d_name;
+        struct stat st{};
+        if (stat((root + "/" + path).c_str(), &st) != 0) {
+            continue;
+        }
+        if (S_ISDIR(st.st_mode)) {
+            walk(root, path, entries);
+            continue;
+        }
+
+        Entry entry;
+        entry.path = path;
+        entry.name = root + "/" + path;
+        time_t mtime = st.st_mtime;
+        struct tm *tm = localtime(&mtime);
+        if (tm && tm->tm_year >= 80) {
+            entry.date = (uint16_t) (((tm->tm_year - 80) << 9) | ((tm->tm_mon + 1) << 5) | tm->tm_mday);
+            entry.time = (uint16_t) ((tm->tm_hour << 11) | (tm->tm_min << 5) | (tm->tm_sec / 2));
+        } else {
+            entry.date = (1 << 5) | 1;
+        }
+        entries->push_back(entry);
+    }
+    closedir(d);
+}
+
+static bool deflateData(const std::vector<uint8_t> &in, std::vector<uint8_t> *out, int level) {
+    z_stream zs{};
+    if (deflateInit2(&zs, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return false;
+    }
+    out->resize(deflateBound(&zs, (uLong) in.size()));
+    zs.next_in = (Bytef *) in.data();
+    zs.avail_in = (uInt) in.size();
+    zs.next_out = out->data();
+    zs.avail_out = (uInt) out->size();
+    int res = deflate(&zs, Z_FINISH);
+    out->resize(zs.total_out);
+    deflateEnd(&zs);
+
+    return res == Z_STREAM_END;
+}
+
+int main(int argc, char **argv) {
+    int alignment = 16;
+    int level = Z_BEST_COMPRESSION;
+    int arg = 1;
+    for (; arg < argc - 2; arg++) {
+        if (strcmp(argv[arg], "-a") == 0 && arg + 1 < argc - 2) {
+            alignment = atoi(argv[++arg]);
+        } else if (strcmp(argv[arg], "-l") == 0 && arg + 1 < argc - 2) {
+            level = atoi(argv[++arg]);
+        } else {
+            break;
+        }
+    }
+    if (argc - arg != 2 || alignment < 1 || alignment > 4096 || (alignment & (alignment - 1)) != 0) {
+        fprintf(stderr, "usage: romfs_pack [-a alignment (power of two)] [-l level (0-9)] <romfs directory> <output.pak>\n");
+        return 1;
+    }
+
+    std::string root = argv[arg];
+    while (root.size() > 1 && root.back() == '/') {
+        root.pop_back();
+    }
+
+    std::vector<Entry> entries;
+    walk(root, "", &entries);
+    // reproducible output, and directories content grouped together
+    std::sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) {
+        return a.path < b.path;
+    });
+    if (entries.size() >= 0xFFFF) {
+        fprintf(stderr, "romfs_pack: too many files (%zu)\n", entries.size());
+        return 1;
+    }
+
+    FILE *out = fopen(argv[arg + 1], "wb");
+    if (!out) {
+        fprintf(stderr, "romfs_pack: could not open %s for writing\n", argv[arg + 1]);
+        return 1;
+    }
+
+    uint64_t offset = 0, total = 0, deflated = 0;
+    std::vector<uint8_t> data, compressed, header;
+    for (auto &entry: entries) {
+        FILE *in = fopen(entry.name.c_str(), "rb");
+        if (!in) {
+            fprintf(stderr, "romfs_pack: could not open %s\n", entry.name.c_str());
+            fclose(out);
+            return 1;
+        }
+        fseek(in, 0, SEEK_END);
+        long size = ftell(in);
+        fseek(in, 0, SEEK_SET);
+        data.resize((size_t) size);
+        bool ok = size >= 0 && fread(data.data(), 1, data.size(), in) == data.size();
+        fclose(in);
+        if (!ok || (uint64_t) size >= 0xFFFFFFFF) {
+            fprintf(stderr, "romfs_pack: could not read %s\n", entry.name.c_str());
+            fclose(out);
+            return 1;
+        }
+
+        entry.size = (uint32_t) data.size();
+        entry.crc = (uint32_t) crc32(0, data.data(), (uInt) data.size());
+        entry.method = 0;
+        // only keep the deflated data if it saves at least 1/8th, stored entries are zero copy
+        if (level > 0 && data.size() >= 128 && !isStored(entry.path)
+            && deflateData(data, &compressed, level) && compressed.size() < data.size() - data.size() / 8) {
+            entry.method = 8;
+        }
+        const std::vector<uint8_t> &payload = entry.method == 8 ? compressed : data;
+        entry.compressedSize = (uint32_t) payload.size();
+        entry.offset = (uint32_t) offset;
+
+        // pad the local header extra field so stored data starts on an aligned offset
+        size_t base = offset + 30 + entry.path.size();
+        size_t padding = 0;
+        if (entry.method == 0 && alignment > 1) {
+            padding = (alignment - (base + 4) % alignment) % alignment + 4;
+        }
+
+        header.clear();
+        put(&header, ZIP_LOCAL_HEADER_SIG, 4);
+        put(&header, 20, 2);
+        put(&header, ZIP_FLAG_UTF8, 2);
+        put(&header, entry.method, 2);
+        put(&header, entry.time, 2);
+        put(&header, entry.date, 2);
+        put(&header, entry.crc, 4);
+        put(&header, entry.compressedSize, 4);
+        put(&header, entry.size, 4);
+        put(&header, (uint32_t) entry.path.size(), 2);
+        put(&header, (uint32_t) padding, 2);
+        header.insert(header.end(), entry.path.begin(), entry.path.end());
+        if (padding > 0) {
+            put(&header, ZIP_ALIGN_EXTRA_ID, 2);
+            put(&header, (uint32_t) padding - 4, 2);
+            header.resize(header.size() + padding - 4, 0);
+        }
+
+        fwrite(header.data(), 1, header.size(), out);
+        fwrite(payload.data(), 1, payload.size(), out);
+        offset += header.size() + payload.size();
+        total += entry.size;
+        deflated += entry.method == 8;
+        if (offset >= 0xFFFFFFFF) {
+            fprintf(stderr, "romfs_pack: archive too big\n");
+            fclose(out);
+            return 1;
+        }
+    }
+
+    // central directory
+    header.clear();
+    for (const auto &entry: entries) {
+        put(&header, ZIP_CENTRAL_HEADER_SIG, 4);
+        put(&header, 20, 2);
+        put(&header, 20, 2);
+        put(&header, ZIP_FLAG_UTF8, 2);
+        put(&header, entry.method, 2);
+        put(&header, entry.time, 2);
+        put(&header, entry.date, 2);
+        put(&header, entry.crc, 4);
+        put(&header, entry.compressedSize, 4);
+        put(&header, entry.size, 4);
+        put(&header, (uint32_t) entry.path.size(), 2);
+        put(&header, 0, 2);     // extra
+        put(&header, 0, 2);     // comment
+        put(&header, 0, 2);     // disk
+        put(&header, 0, 2);     // internal attributes
+        put(&header, 0, 4);     // external attributes
+        put(&header, entry.offset, 4);
+        header.insert(header.end(), entry.path.begin(), entry.path.end());
+    }
+    auto directorySize = (uint32_t) header.size();
+    put(&header, ZIP_END_SIG, 4);
+    put(&header, 0, 2);
+    put(&header, 0, 2);
+    put(&header, (uint32_t) entries.size(), 2);
+    put(&header, (uint32_t) entries.size(), 2);
+    put(&header, directorySize, 4);
+    put(&header, (uint32_t) offset, 4);
+    put(&header, 0, 2);
+    fwrite(header.data(), 1, header.size(), out);
+
+    bool ok = ferror(out) == 0;
+    ok &= fclose(out) == 0;
+    if (!ok) {
+        fprintf(stderr, "romfs_pack: could not write %s\n", argv[arg + 1]);
+        return 1;
+    }
+
+    printf("romfs_pack: %s: %zu files (%llu deflated), %llu bytes packed into %llu\n",
+           argv[arg + 1], entries.size(), (unsigned long long) deflated,
+           (unsigned long long) total, (unsigned long long) (offset + header.size()));
+
+    return 0;
+}
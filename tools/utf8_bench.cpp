@@ -0,0 +1,87 @@
+//
+// Created by cpasjuste on 17/10/2026.
+//
+
+// UTF-8 decoding benchmark: Utility::utf8ToUtf32 (decoding and counting modes) against a
+// plain byte by byte decoder, on ascii, latin and cjk texts. Results are checked first.
+//
+// usage: c2d_utf8_bench [iterations]
+
+#include <chrono>
+#include "cross2d/c2d.h"
+
+using namespace c2d;
+
+// reference decoder, one code point per iteration (no replacement handling, valid input only)
+static std::u32string decodeSimple(const std::string &str) {
+    std::u32string out;
+    out.reserve(str.size());
+    size_t i = 0;
+    while (i < str.size()) {
+        auto c = (unsigned char) str[i];
+        int n = Utility::getCharacterBytes(c);
+        char32_t cp = n == 1 ? c : c & (0xFF >> (n + 1));
+        for (int k = 1; k < n; k++) {
+            cp = (cp << 6) | (str[i + k] & 0x3F);
+        }
+        out.push_back(cp);
+        i += n;
+    }
+    return out;
+}
+
+template<typename Fn>
+static double run(std::string &text, int iterations, Fn fn) {
+    size_t total = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        total += fn(text);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    // keep the results alive
+    if (total == 0) {
+        printf("utf8_bench: nothing decoded\n");
+    }
+    return seconds > 0 ? (double) text.size() * iterations / seconds / (1024 * 1024) : 0;
+}
+
+int main(int argc, char **argv) {
+    int iterations = argc > 1 ? Utility::parseInt(argv[1], 200) : 200;
+
+    std::string ascii, latin, cjk;
+    for (int i = 0; i < 2000; i++) {
+        ascii += "The quick brown fox jumps over the lazy dog. ";
+        latin += "Le cœur déçu mais l'âme plutôt naïve, Louÿs rêva de crapaüter. ";
+        cjk += "中文字体渲染测试，日本語のテキスト。한국어 텍스트 ";
+    }
+
+    struct Text {
+        const char *name;
+        std::string *text;
+    };
+    Text texts[] = {{"ascii", &ascii}, {"latin", &latin}, {"cjk",   &cjk}};
+
+    for (const auto &t: texts) {
+        std::string &text = *t.text;
+        std::u32string decoded = Utility::utf8ToUtf32(text);
+        if (decoded != decodeSimple(text) || (size_t) Utility::getCharacterNum(text) != decoded.size()) {
+            printf("utf8_bench: %s: results mismatch\n", t.name);
+            return 1;
+        }
+
+        double simple = run(text, iterations, [](std::string &s) {
+            return decodeSimple(s).size();
+        });
+        double decode = run(text, iterations, [](std::string &s) {
+            return Utility::utf8ToUtf32(s).size();
+        });
+        double count = run(text, iterations, [](std::string &s) {
+            return (size_t) Utility::getCharacterNum(s);
+        });
+
+        printf("%-6s simple: %8.1f MB/s, utf8ToUtf32: %8.1f MB/s, getCharacterNum: %8.1f MB/s\n",
+               t.name, simple, decode, count);
+    }
+
+    return 0;
+}